@@ -0,0 +1,149 @@
+/* ========== <vbbuffersearch.c>				==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Free slot search of fixed buffers at fixed occupancy		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+#include <intrin.h>
+
+
+/* ========== CONSTANTS							==========	*/
+#define SEARCH_CAPACITY		0xF000
+#define SEARCH_WORDS		(SEARCH_CAPACITY >> 0x06)
+#define SEARCH_OPERATIONS	0x40000
+#define SEARCH_RING			0x400	/* claims kept before release	*/
+
+
+/* ========== HELPER							==========	*/
+/* bit at a time search the buffer used before word scanning */
+static __forceinline vUI64 vhSearchBitwise(vPUI64 field, vUI64 used)
+{
+	vUI16 startIndex = (vUI16)(used >> 0x1);
+	for (vUI64 i = 0; i < SEARCH_CAPACITY; i++)
+	{
+		vUI64 index = (i + startIndex) % SEARCH_CAPACITY;
+		if (_bittest64((LONG64*)field + (index >> 0x06), index & 0x3F) == FALSE)
+			return index;
+	}
+	return ~0ULL;
+}
+
+/* word scan from a hint, as vBufferAdd does now */
+static __forceinline vUI64 vhSearchWordwise(vPUI64 field, vPUI64 hint)
+{
+	for (vUI64 i = 0; i < SEARCH_WORDS; i++)
+	{
+		vUI64 chunk = *hint + i;
+		if (chunk >= SEARCH_WORDS) chunk -= SEARCH_WORDS;
+
+		vUI64 freeMask = ~field[chunk];
+		if (freeMask == 0) continue;
+
+		unsigned long bit;
+		_BitScanForward64(&bit, freeMask);
+		*hint = chunk;
+		return (chunk << 0x06) + bit;
+	}
+	return ~0ULL;
+}
+
+/* fills to the given occupancy and seeds the release ring with */
+/* random used slots, so both searches churn the same pattern	*/
+static void vhSearchFill(vPUI64 field, vUI32 occupancy, vPUI64 ring, vPUI64 state)
+{
+	vZeroMemory(field, sizeof(vUI64) * SEARCH_WORDS);
+	vUI64 used = ((vUI64)SEARCH_CAPACITY * occupancy) / 100;
+	for (vUI64 filled = 0; filled < used; )
+	{
+		vUI64 index = vbRandom(state) % SEARCH_CAPACITY;
+		if (_bittestandset64((LONG64*)field + (index >> 0x06), index & 0x3F)) continue;
+		if (filled < SEARCH_RING) ring[filled] = index;
+		filled++;
+	}
+}
+
+static double vhSearchRun(vUI32 occupancy, vBOOL wordwise)
+{
+	vUI64 field[SEARCH_WORDS];
+	vUI64 ring[SEARCH_RING];
+	vUI64 state = 0x9E3779B97F4A7C15ULL;
+	vhSearchFill(field, occupancy, ring, &state);
+
+	vUI64 used = ((vUI64)SEARCH_CAPACITY * occupancy) / 100;
+	vUI64 hint = 0;
+	vUI64 ringHead = 0;
+
+	/* claim one, release the oldest claim, occupancy stays put */
+	LARGE_INTEGER start = vbTimerStart();
+	for (vUI64 i = 0; i < SEARCH_OPERATIONS; i++)
+	{
+		vUI64 index = wordwise ? vhSearchWordwise(field, &hint) :
+			vhSearchBitwise(field, used);
+		_bittestandset64((LONG64*)field + (index >> 0x06), index & 0x3F);
+
+		vUI64 release = ring[ringHead];
+		_bittestandreset64((LONG64*)field + (release >> 0x06), release & 0x3F);
+		ring[ringHead] = index;
+		ringHead = (ringHead + 1) % SEARCH_RING;
+	}
+	return vbTimerSeconds(start);
+}
+
+static double vhSearchRunBuffer(vUI32 occupancy)
+{
+	vHNDL buffer = vCreateBuffer("Search Bench Buffer", sizeof(vUI64),
+		SEARCH_CAPACITY, NULL, NULL);
+
+	/* fill completely then remove at random down to occupancy */
+	vPTR* elements = vAlloc(sizeof(vPTR) * SEARCH_CAPACITY);
+	for (vUI64 i = 0; i < SEARCH_CAPACITY; i++)
+		elements[i] = vBufferAdd(buffer, NULL);
+
+	vUI64 state = 0x9E3779B97F4A7C15ULL;
+	vbShuffle(elements, SEARCH_CAPACITY, &state);
+	vUI64 used = ((vUI64)SEARCH_CAPACITY * occupancy) / 100;
+	for (vUI64 i = used; i < SEARCH_CAPACITY; i++)
+		vBufferRemove(buffer, elements[i]);
+
+	vPTR ring[SEARCH_RING];
+	vMemCopy(ring, elements, sizeof(ring));
+	vUI64 ringHead = 0;
+
+	LARGE_INTEGER start = vbTimerStart();
+	for (vUI64 i = 0; i < SEARCH_OPERATIONS; i++)
+	{
+		vPTR element = vBufferAdd(buffer, NULL);
+		vBufferRemove(buffer, ring[ringHead]);
+		ring[ringHead] = element;
+		ringHead = (ringHead + 1) % SEARCH_RING;
+	}
+	double seconds = vbTimerSeconds(start);
+
+	vFree(elements);
+	vDestroyBuffer(buffer);
+	return seconds;
+}
+
+
+/* ========== BENCHMARK							==========	*/
+void vbBufferSearch(void)
+{
+	const vUI32 occupancies[] = { 50, 90, 99 };
+	for (int i = 0; i < sizeof(occupancies) / sizeof(occupancies[0]); i++)
+	{
+		vCHAR variant[BUFF_SMALL];
+
+		sprintf_s(variant, sizeof(variant), "bitwise search %u%%", occupancies[i]);
+		vbReport(__func__, variant, SEARCH_OPERATIONS,
+			vhSearchRun(occupancies[i], FALSE));
+
+		sprintf_s(variant, sizeof(variant), "wordwise search %u%%", occupancies[i]);
+		vbReport(__func__, variant, SEARCH_OPERATIONS,
+			vhSearchRun(occupancies[i], TRUE));
+
+		sprintf_s(variant, sizeof(variant), "vBufferAdd+Remove %u%%", occupancies[i]);
+		vbReport(__func__, variant, SEARCH_OPERATIONS,
+			vhSearchRunBuffer(occupancies[i]));
+	}
+}
@@ -0,0 +1,99 @@
+/* ========== <vbbufferthreads.c>				==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Fixed buffer add/remove throughput across thread counts	*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+
+
+/* ========== CONSTANTS							==========	*/
+#define THREADS_MAX			0x20
+#define THREADS_CAPACITY	0x8000
+#define THREADS_HELD		0x20	/* elements each thread keeps	*/
+#define THREADS_OPERATIONS	0x40000	/* add/remove pairs per thread	*/
+
+
+/* ========== THREAD STATE						==========	*/
+typedef struct vBenchThread
+{
+	vHNDL buffer;
+	volatile LONG* startFlag;
+} vBenchThread, *vPBenchThread;
+
+
+/* ========== HELPER							==========	*/
+static DWORD WINAPI vhBufferThreadProc(vPBenchThread thread)
+{
+	vPTR held[THREADS_HELD];
+	for (int i = 0; i < THREADS_HELD; i++)
+		held[i] = vBufferAdd(thread->buffer, NULL);
+
+	/* every thread starts at once */
+	while (*thread->startFlag == 0) YieldProcessor();
+
+	/* swap the oldest held element for a new one */
+	for (vUI64 i = 0; i < THREADS_OPERATIONS; i++)
+	{
+		vUI64 slot = i % THREADS_HELD;
+		vBufferRemove(thread->buffer, held[slot]);
+		held[slot] = vBufferAdd(thread->buffer, NULL);
+	}
+
+	for (int i = 0; i < THREADS_HELD; i++)
+		vBufferRemove(thread->buffer, held[i]);
+	return 0;
+}
+
+static double vhBufferThreadsRun(vBYTE flags, vUI32 threadCount)
+{
+	vHNDL buffer = vCreateBufferEx("Thread Bench Buffer", sizeof(vUI64),
+		THREADS_CAPACITY, NULL, NULL, flags);
+
+	volatile LONG startFlag = 0;
+	vBenchThread threads[THREADS_MAX];
+	HANDLE handles[THREADS_MAX];
+	for (vUI32 i = 0; i < threadCount; i++)
+	{
+		threads[i].buffer	 = buffer;
+		threads[i].startFlag = &startFlag;
+		handles[i] = CreateThread(NULL, 0, vhBufferThreadProc, threads + i, 0, NULL);
+	}
+
+	/* give every thread time to fill its held elements */
+	Sleep(50);
+	LARGE_INTEGER start = vbTimerStart();
+	InterlockedExchange(&startFlag, 1);
+	WaitForMultipleObjects(threadCount, handles, TRUE, INFINITE);
+	double seconds = vbTimerSeconds(start);
+
+	for (vUI32 i = 0; i < threadCount; i++)
+		CloseHandle(handles[i]);
+	vDestroyBuffer(buffer);
+	return seconds;
+}
+
+
+/* ========== BENCHMARK							==========	*/
+void vbBufferThreads(void)
+{
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	vUI32 maxThreads = min(THREADS_MAX, systemInfo.dwNumberOfProcessors);
+
+	/* doubling thread counts, always ending on the full machine */
+	for (vUI32 threadCount = 1; ; threadCount = min(threadCount * 2, maxThreads))
+	{
+		vCHAR variant[BUFF_SMALL];
+		vUI64 operations = (vUI64)threadCount * THREADS_OPERATIONS * 2;
+
+		sprintf_s(variant, sizeof(variant), "locked %u threads", threadCount);
+		vbReport(__func__, variant, operations, vhBufferThreadsRun(0, threadCount));
+
+		sprintf_s(variant, sizeof(variant), "lock-free %u threads", threadCount);
+		vbReport(__func__, variant, operations,
+			vhBufferThreadsRun(BUFFER_FLAG_LOCKFREE, threadCount));
+
+		if (threadCount == maxThreads) break;
+	}
+}
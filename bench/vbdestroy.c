@@ -0,0 +1,62 @@
+/* ========== <vbdestroy.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Random order destruction through owning node lookup		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+
+
+/* ========== CONSTANTS							==========	*/
+#define DESTROY_COUNT		1000000
+#define DESTROY_NODE_SIZE	0x800
+
+
+/* ========== HELPER							==========	*/
+static double vhDestroyRunDBuffer(void)
+{
+	vHNDL dBuffer = vCreateDBuffer("Destroy Bench Buffer", sizeof(vUI64),
+		DESTROY_NODE_SIZE, NULL, NULL);
+
+	vPTR* elements = vAlloc(sizeof(vPTR) * DESTROY_COUNT);
+	for (vUI64 i = 0; i < DESTROY_COUNT; i++)
+		elements[i] = vDBufferAdd(dBuffer, NULL);
+
+	vUI64 state = 0x9E3779B97F4A7C15ULL;
+	vbShuffle(elements, DESTROY_COUNT, &state);
+
+	LARGE_INTEGER start = vbTimerStart();
+	for (vUI64 i = 0; i < DESTROY_COUNT; i++)
+		vDBufferRemove(dBuffer, elements[i]);
+	double seconds = vbTimerSeconds(start);
+
+	vFree(elements);
+	vDestroyDBuffer(dBuffer);
+	return seconds;
+}
+
+static double vhDestroyRunObjects(void)
+{
+	vPTR* objects = vAlloc(sizeof(vPTR) * DESTROY_COUNT);
+	for (vUI64 i = 0; i < DESTROY_COUNT; i++)
+		objects[i] = vCreateObject(NULL);
+
+	vUI64 state = 0x9E3779B97F4A7C15ULL;
+	vbShuffle(objects, DESTROY_COUNT, &state);
+
+	LARGE_INTEGER start = vbTimerStart();
+	for (vUI64 i = 0; i < DESTROY_COUNT; i++)
+		vDestroyObject(objects[i]);
+	double seconds = vbTimerSeconds(start);
+
+	vFree(objects);
+	return seconds;
+}
+
+
+/* ========== BENCHMARK							==========	*/
+void vbDestroy(void)
+{
+	vbReport(__func__, "vDBufferRemove 1M random", DESTROY_COUNT, vhDestroyRunDBuffer());
+	vbReport(__func__, "vDestroyObject 1M random", DESTROY_COUNT, vhDestroyRunObjects());
+}
@@ -0,0 +1,58 @@
+/* ========== <vbench.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+#include <string.h>
+
+
+/* ========== BENCHMARK TABLE					==========	*/
+typedef struct vBenchEntry
+{
+	const char* name;
+	void (*function)(void);
+} vBenchEntry;
+
+static const vBenchEntry benches[] =
+{
+	{ "buffersearch",	vbBufferSearch	},
+	{ "bufferthreads",	vbBufferThreads	},
+	{ "destroy",		vbDestroy		},
+	{ "readers",		vbReaders		},
+	{ "nodescan",		vbNodeScan		},
+	{ "layout",			vbLayout		},
+	{ "spawn",			vbSpawn			},
+	{ "kernels",		vbKernels		},
+};
+
+
+/* ========== ENTRY POINT						==========	*/
+/* runs every benchmark named on the command line, or all	*/
+/* of them when none are named								*/
+int main(int argc, char** argv)
+{
+	vCoreInitialize();
+
+	vUI32 ran = 0;
+	for (vUI32 i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+	{
+		vBOOL selected = (argc <= 1);
+		for (int j = 1; j < argc && selected == FALSE; j++)
+			selected = (strcmp(argv[j], benches[i].name) == 0);
+		if (selected == FALSE) continue;
+
+		benches[i].function();
+		ran++;
+	}
+
+	if (ran == 0)
+	{
+		printf("No benchmark matched. Available:\n");
+		for (vUI32 i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+			printf("  %s\n", benches[i].name);
+		return 1;
+	}
+
+	return 0;
+}
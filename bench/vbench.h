@@ -0,0 +1,75 @@
+/* ========== <vbench.h>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Standalone benchmarks for the VCore containers			*/
+
+#ifndef _VCORE_BENCH_INCLUDE_
+#define _VCORE_BENCH_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "../vcore.h"
+#include <stdio.h>
+
+
+/* ========== TIMING							==========	*/
+static __forceinline LARGE_INTEGER vbTimerStart(void)
+{
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	return start;
+}
+
+static __forceinline double vbTimerSeconds(LARGE_INTEGER start)
+{
+	LARGE_INTEGER end, frequency;
+	QueryPerformanceCounter(&end);
+	QueryPerformanceFrequency(&frequency);
+	return (double)(end.QuadPart - start.QuadPart) / (double)frequency.QuadPart;
+}
+
+
+/* ========== RANDOM							==========	*/
+/* xorshift, every run sees the same sequence for one seed	*/
+static __forceinline vUI64 vbRandom(vPUI64 state)
+{
+	vUI64 x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return x;
+}
+
+/* fisher-yates shuffle of a pointer array */
+static __forceinline void vbShuffle(vPTR* items, vUI64 count, vPUI64 state)
+{
+	for (vUI64 i = count; i > 1; i--)
+	{
+		vUI64 j = vbRandom(state) % i;
+		vPTR temp    = items[i - 1];
+		items[i - 1] = items[j];
+		items[j]     = temp;
+	}
+}
+
+
+/* ========== REPORTING							==========	*/
+static __forceinline void vbReport(const char* bench, const char* variant,
+	vUI64 operations, double seconds)
+{
+	printf("%-16s %-36s %12.2f ns/op %10.2f Mop/s\n", bench, variant,
+		(seconds * 1e9) / (double)max(1, operations),
+		((double)operations / max(seconds, 1e-9)) / 1e6);
+}
+
+
+/* ========== BENCHMARKS						==========	*/
+void vbBufferSearch(void);
+void vbBufferThreads(void);
+void vbDestroy(void);
+void vbReaders(void);
+void vbNodeScan(void);
+void vbLayout(void);
+void vbSpawn(void);
+void vbKernels(void);
+
+#endif
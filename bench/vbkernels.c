@@ -0,0 +1,109 @@
+/* ========== <vbkernels.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Transform batch kernels at every SIMD level				*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+
+
+/* ========== CONSTANTS							==========	*/
+#define KERNELS_COUNT		0x10000
+#define KERNELS_PASSES		0x100
+
+
+/* ========== HELPER							==========	*/
+static void vhKernelsFill(vPTransformSoA store, vPUI64 state)
+{
+	for (vUI32 i = 0; i < KERNELS_COUNT; i++)
+	{
+		float x = (float)(vbRandom(state) % 2000) - 1000.0f;
+		float y = (float)(vbRandom(state) % 2000) - 1000.0f;
+		vTransformSoAPush(store, vCreateTransformF(x, y, 0.001f * (float)i, 1.0f));
+	}
+}
+
+static void vhKernelsRun(const char* levelName, vPTransformSoA parents,
+	vPTransformSoA locals, vPTransformSoA worlds, float* distances, vPUI32 indices)
+{
+	vCHAR variant[BUFF_SMALL];
+	vUI64 operations = (vUI64)KERNELS_PASSES * KERNELS_COUNT;
+	vPosition origin = vCreatePosition(0.0f, 0.0f);
+	LARGE_INTEGER start;
+
+	start = vbTimerStart();
+	for (int i = 0; i < KERNELS_PASSES; i++)
+		vTransformTranslate(locals, 0, KERNELS_COUNT, 0.5f, -0.5f);
+	sprintf_s(variant, sizeof(variant), "translate %s", levelName);
+	vbReport("vbKernels", variant, operations, vbTimerSeconds(start));
+
+	start = vbTimerStart();
+	for (int i = 0; i < KERNELS_PASSES; i++)
+		vTransformRotate(locals, 0, KERNELS_COUNT, 0.01f);
+	sprintf_s(variant, sizeof(variant), "rotate %s", levelName);
+	vbReport("vbKernels", variant, operations, vbTimerSeconds(start));
+
+	/* alternate factors so values stay in range */
+	start = vbTimerStart();
+	for (int i = 0; i < KERNELS_PASSES; i++)
+		vTransformScale(locals, 0, KERNELS_COUNT, (i & 1) ? 0.5f : 2.0f);
+	sprintf_s(variant, sizeof(variant), "scale %s", levelName);
+	vbReport("vbKernels", variant, operations, vbTimerSeconds(start));
+
+	start = vbTimerStart();
+	for (int i = 0; i < KERNELS_PASSES; i++)
+		vTransformCompose(parents, locals, worlds, 0, KERNELS_COUNT);
+	sprintf_s(variant, sizeof(variant), "compose %s", levelName);
+	vbReport("vbKernels", variant, operations, vbTimerSeconds(start));
+
+	start = vbTimerStart();
+	for (int i = 0; i < KERNELS_PASSES; i++)
+		vTransformDistance(worlds, 0, KERNELS_COUNT, origin, distances);
+	sprintf_s(variant, sizeof(variant), "distance %s", levelName);
+	vbReport("vbKernels", variant, operations, vbTimerSeconds(start));
+
+	start = vbTimerStart();
+	for (int i = 0; i < KERNELS_PASSES; i++)
+		vTransformQueryRadius(worlds, 0, KERNELS_COUNT, origin, 500.0f, indices);
+	sprintf_s(variant, sizeof(variant), "query radius %s", levelName);
+	vbReport("vbKernels", variant, operations, vbTimerSeconds(start));
+}
+
+
+/* ========== BENCHMARK							==========	*/
+void vbKernels(void)
+{
+	vTransformSoA parents, locals, worlds;
+	vCreateTransformSoA(&parents, KERNELS_COUNT);
+	vCreateTransformSoA(&locals, KERNELS_COUNT);
+	vCreateTransformSoA(&worlds, KERNELS_COUNT);
+
+	vUI64 state = 0x9E3779B97F4A7C15ULL;
+	vhKernelsFill(&parents, &state);
+	vhKernelsFill(&locals, &state);
+	vhKernelsFill(&worlds, &state);
+
+	float* distances = vAlloc(sizeof(float) * KERNELS_COUNT);
+	vPUI32 indices	 = vAlloc(sizeof(vUI32) * KERNELS_COUNT);
+
+	/* levels the cpu lacks are clamped, skip those */
+	const vBYTE levels[] = { TRANSFORM_SIMD_SCALAR, TRANSFORM_SIMD_SSE41,
+		TRANSFORM_SIMD_AVX2 };
+	const char* levelNames[] = { "scalar", "sse4.1", "avx2" };
+	for (int i = 0; i < sizeof(levels) / sizeof(levels[0]); i++)
+	{
+		if (vTransformSetSIMDLevel(levels[i]) != levels[i])
+		{
+			printf("%-16s %s not supported by this cpu\n", __func__, levelNames[i]);
+			continue;
+		}
+		vhKernelsRun(levelNames[i], &parents, &locals, &worlds, distances, indices);
+	}
+	vTransformSetSIMDLevel(TRANSFORM_SIMD_BEST);
+
+	vFree(distances);
+	vFree(indices);
+	vDestroyTransformSoA(&parents);
+	vDestroyTransformSoA(&locals);
+	vDestroyTransformSoA(&worlds);
+}
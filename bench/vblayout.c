@@ -0,0 +1,110 @@
+/* ========== <vblayout.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Per component type iteration, scattered vs archetype		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+
+
+/* ========== CONSTANTS							==========	*/
+#define LAYOUT_OBJECTS		100000
+#define LAYOUT_PASSES		0x20
+
+
+/* ========== COMPONENTS						==========	*/
+typedef struct vBenchBody
+{
+	float x, y;
+	float velocityX, velocityY;
+} vBenchBody, *vPBenchBody;
+
+static vUI16 layoutBody;
+static vUI16 layoutTag;
+
+
+/* ========== HELPER							==========	*/
+static void vhLayoutBodyInit(vPObject object, vPComponent component, vPTR input)
+{
+	vPBenchBody body = component->objectAttribute;
+	body->velocityX = 1.0f;
+	body->velocityY = 0.5f;
+}
+
+static void vhLayoutColumn(vUI16 component, vPBenchBody column, vPObject* objects,
+	vUI32 rowCount, vPTR input)
+{
+	for (vUI32 i = 0; i < rowCount; i++)
+	{
+		column[i].x += column[i].velocityX;
+		column[i].y += column[i].velocityY;
+	}
+}
+
+static double vhLayoutObjectPasses(vPObject* objects)
+{
+	LARGE_INTEGER start = vbTimerStart();
+	for (int pass = 0; pass < LAYOUT_PASSES; pass++)
+	{
+		for (vUI32 i = 0; i < LAYOUT_OBJECTS; i++)
+		{
+			vPBenchBody body = vObjectGetComponent(objects[i], layoutBody)->objectAttribute;
+			body->x += body->velocityX;
+			body->y += body->velocityY;
+		}
+	}
+	return vbTimerSeconds(start);
+}
+
+static void vhLayoutRun(vBYTE storageMode)
+{
+	vObjectSetStorageMode(storageMode);
+
+	/* a second component moves each object between archetypes */
+	vPObject* objects = vAlloc(sizeof(vPObject) * LAYOUT_OBJECTS);
+	for (vUI32 i = 0; i < LAYOUT_OBJECTS; i++)
+	{
+		objects[i] = vCreateObject(NULL);
+		vObjectAddComponent(objects[i], layoutBody, NULL);
+		vObjectAddComponent(objects[i], layoutTag, NULL);
+	}
+
+	const char* mode = (storageMode == OBJECT_STORAGE_ARCHETYPE) ?
+		"archetype" : "scattered";
+	vCHAR variant[BUFF_SMALL];
+	vUI64 operations = (vUI64)LAYOUT_PASSES * LAYOUT_OBJECTS;
+
+	/* attribute pointers need the archetype lock to stay put */
+	if (storageMode == OBJECT_STORAGE_ARCHETYPE) vArchetypeLockShared();
+	sprintf_s(variant, sizeof(variant), "%s, per object", mode);
+	vbReport("vbLayout", variant, operations, vhLayoutObjectPasses(objects));
+	if (storageMode == OBJECT_STORAGE_ARCHETYPE) vArchetypeUnlockShared();
+
+	if (storageMode == OBJECT_STORAGE_ARCHETYPE)
+	{
+		LARGE_INTEGER start = vbTimerStart();
+		for (int pass = 0; pass < LAYOUT_PASSES; pass++)
+			vArchetypeIterateComponent(layoutBody, vhLayoutColumn, NULL);
+		sprintf_s(variant, sizeof(variant), "%s, per column", mode);
+		vbReport("vbLayout", variant, operations, vbTimerSeconds(start));
+	}
+
+	/* storage mode only changes while no objects exist */
+	for (vUI32 i = 0; i < LAYOUT_OBJECTS; i++)
+		vDestroyObject(objects[i]);
+	vFree(objects);
+}
+
+
+/* ========== BENCHMARK							==========	*/
+void vbLayout(void)
+{
+	layoutBody = vCreateComponent("Layout Bench Body", 0, sizeof(vBenchBody), NULL,
+		vhLayoutBodyInit, NULL, NULL, NULL);
+	layoutTag  = vCreateComponent("Layout Bench Tag", 0, sizeof(vUI32), NULL,
+		NULL, NULL, NULL, NULL);
+
+	vhLayoutRun(OBJECT_STORAGE_SCATTERED);
+	vhLayoutRun(OBJECT_STORAGE_ARCHETYPE);
+	vObjectSetStorageMode(OBJECT_STORAGE_SCATTERED);
+}
@@ -0,0 +1,83 @@
+/* ========== <vbnodescan.c>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Dynamic buffer iterate and clear over node occupancies	*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+
+
+/* ========== CONSTANTS							==========	*/
+#define NODESCAN_NODE_SIZE	0x800
+#define NODESCAN_NODES		0x40
+#define NODESCAN_ELEMENTS	(NODESCAN_NODE_SIZE * NODESCAN_NODES)
+#define NODESCAN_PASSES		0x40
+#define NODESCAN_CLEARS		0x08
+
+
+/* ========== HELPER							==========	*/
+static void vhNodeScanVisit(vHNDL dBuffer, vPUI64 element, vPUI64 sum)
+{
+	*sum += *element;
+}
+
+/* fills every node, then keeps every stride'th slot of each */
+static void vhNodeScanFill(vHNDL dBuffer, vPTR* elements, vUI32 stride)
+{
+	for (vUI64 i = 0; i < NODESCAN_ELEMENTS; i++)
+		elements[i] = vDBufferAdd(dBuffer, NULL);
+	for (vUI64 i = 0; i < NODESCAN_ELEMENTS; i++)
+	{
+		if ((i % stride) != 0) vDBufferRemove(dBuffer, elements[i]);
+	}
+}
+
+static void vhNodeScanRun(const char* pattern, vUI32 stride)
+{
+	vHNDL dBuffer = vCreateDBuffer("Node Scan Bench Buffer", sizeof(vUI64),
+		NODESCAN_NODE_SIZE, NULL, NULL);
+
+	/* cleared nodes must stay around for the next fill */
+	vDBufferSetTrimPolicy(dBuffer, 0, 0);
+
+	vPTR* elements = vAlloc(sizeof(vPTR) * NODESCAN_ELEMENTS);
+	vhNodeScanFill(dBuffer, elements, stride);
+	vUI64 live = vDBufferGetElementCount(dBuffer);
+
+	vCHAR variant[BUFF_SMALL];
+	vUI64 sum = 0;
+
+	/* cost per slot scanned, so patterns compare directly */
+	LARGE_INTEGER start = vbTimerStart();
+	for (int i = 0; i < NODESCAN_PASSES; i++)
+		vDBufferIterate(dBuffer, vhNodeScanVisit, &sum);
+	double seconds = vbTimerSeconds(start);
+	sprintf_s(variant, sizeof(variant), "iterate %s, %llu live", pattern, live);
+	vbReport("vbNodeScan", variant, (vUI64)NODESCAN_PASSES * NODESCAN_ELEMENTS, seconds);
+
+	/* refills are not timed */
+	seconds = 0.0;
+	for (int i = 0; i < NODESCAN_CLEARS; i++)
+	{
+		if (i > 0) vhNodeScanFill(dBuffer, elements, stride);
+
+		start = vbTimerStart();
+		vDBufferClear(dBuffer);
+		seconds += vbTimerSeconds(start);
+	}
+	sprintf_s(variant, sizeof(variant), "clear %s, %llu live", pattern, live);
+	vbReport("vbNodeScan", variant, (vUI64)NODESCAN_CLEARS * NODESCAN_ELEMENTS, seconds);
+
+	vFree(elements);
+	vDestroyDBuffer(dBuffer);
+}
+
+
+/* ========== BENCHMARK							==========	*/
+void vbNodeScan(void)
+{
+	/* sparse keeps 3 of every 2048 slots */
+	vhNodeScanRun("sparse", (NODESCAN_NODE_SIZE / 3) + 1);
+	vhNodeScanRun("half", 2);
+	vhNodeScanRun("full", 1);
+}
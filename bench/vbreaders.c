@@ -0,0 +1,129 @@
+/* ========== <vbreaders.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Concurrent iteration with one writer per container		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+
+
+/* ========== CONSTANTS							==========	*/
+#define READERS_COUNT		8
+#define READERS_ELEMENTS	0x4000
+#define READERS_NODE_SIZE	0x800
+#define READERS_RUN_MSECS	1000
+
+
+/* ========== THREAD STATE						==========	*/
+typedef struct vBenchReaders
+{
+	vHNDL  container;
+	vBOOL  fixed;			/* vBuffer instead of vDBuffer		*/
+	vBOOL  exclusive;		/* readers serialize like before	*/
+	volatile LONG  running;
+	volatile LONG64 passes;
+	volatile LONG64 writes;
+} vBenchReaders, *vPBenchReaders;
+
+
+/* ========== HELPER							==========	*/
+static void vhReadersVisit(vHNDL buffer, vUI16 index, vPUI64 element, vPUI64 sum)
+{
+	*sum += *element;
+}
+
+static void vhReadersVisitDynamic(vHNDL dBuffer, vPUI64 element, vPUI64 sum)
+{
+	*sum += *element;
+}
+
+static DWORD WINAPI vhReadersReaderProc(vPBenchReaders bench)
+{
+	vUI64 sum = 0;
+	while (bench->running)
+	{
+		/* an exclusive hold around the pass reproduces the old	*/
+		/* behaviour, the pass's own shared lock nests inside it	*/
+		if (bench->fixed)
+		{
+			if (bench->exclusive) vBufferLock(bench->container);
+			vBufferIterate(bench->container, vhReadersVisit, &sum);
+			if (bench->exclusive) vBufferUnlock(bench->container);
+		}
+		else
+		{
+			if (bench->exclusive) vDBufferLock(bench->container);
+			vDBufferIterate(bench->container, vhReadersVisitDynamic, &sum);
+			if (bench->exclusive) vDBufferUnlock(bench->container);
+		}
+		InterlockedIncrement64(&bench->passes);
+	}
+	return (DWORD)sum;
+}
+
+static DWORD WINAPI vhReadersWriterProc(vPBenchReaders bench)
+{
+	while (bench->running)
+	{
+		if (bench->fixed)
+			vBufferRemove(bench->container, vBufferAdd(bench->container, NULL));
+		else
+			vDBufferRemove(bench->container, vDBufferAdd(bench->container, NULL));
+		InterlockedIncrement64(&bench->writes);
+	}
+	return 0;
+}
+
+static void vhReadersRun(vBOOL fixed, vBOOL exclusive)
+{
+	vBenchReaders bench;
+	vZeroMemory(&bench, sizeof(bench));
+	bench.fixed		= fixed;
+	bench.exclusive = exclusive;
+	bench.running	= 1;
+	bench.container = fixed ?
+		vCreateBuffer("Readers Bench Buffer", sizeof(vUI64), READERS_ELEMENTS + 1,
+			NULL, NULL) :
+		vCreateDBuffer("Readers Bench Buffer", sizeof(vUI64), READERS_NODE_SIZE,
+			NULL, NULL);
+	for (int i = 0; i < READERS_ELEMENTS; i++)
+	{
+		if (fixed)	vBufferAdd(bench.container, NULL);
+		else		vDBufferAdd(bench.container, NULL);
+	}
+
+	HANDLE threads[READERS_COUNT + 1];
+	for (int i = 0; i < READERS_COUNT; i++)
+		threads[i] = CreateThread(NULL, 0, vhReadersReaderProc, &bench, 0, NULL);
+	threads[READERS_COUNT] = CreateThread(NULL, 0, vhReadersWriterProc, &bench, 0, NULL);
+
+	LARGE_INTEGER start = vbTimerStart();
+	Sleep(READERS_RUN_MSECS);
+	InterlockedExchange(&bench.running, 0);
+	WaitForMultipleObjects(READERS_COUNT + 1, threads, TRUE, INFINITE);
+	double seconds = vbTimerSeconds(start);
+
+	for (int i = 0; i <= READERS_COUNT; i++)
+		CloseHandle(threads[i]);
+	if (fixed)	vDestroyBuffer(bench.container);
+	else		vDestroyDBuffer(bench.container);
+
+	/* one reader op is one element visited */
+	vCHAR variant[BUFF_SMALL];
+	sprintf_s(variant, sizeof(variant), "%s %s, 8 readers",
+		fixed ? "buffer" : "dbuffer", exclusive ? "exclusive" : "shared");
+	vbReport("vbReaders", variant, bench.passes * READERS_ELEMENTS, seconds);
+	sprintf_s(variant, sizeof(variant), "%s %s, 1 writer",
+		fixed ? "buffer" : "dbuffer", exclusive ? "exclusive" : "shared");
+	vbReport("vbReaders", variant, bench.writes, seconds);
+}
+
+
+/* ========== BENCHMARK							==========	*/
+void vbReaders(void)
+{
+	vhReadersRun(FALSE, TRUE);
+	vhReadersRun(FALSE, FALSE);
+	vhReadersRun(TRUE, TRUE);
+	vhReadersRun(TRUE, FALSE);
+}
@@ -0,0 +1,84 @@
+/* ========== <vbspawn.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Object spawn throughput, prefab vs one call at a time	*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vbench.h"
+
+
+/* ========== CONSTANTS							==========	*/
+#define SPAWN_OBJECTS		100000
+#define SPAWN_COMPONENTS	4
+#define SPAWN_ROUNDS		4
+
+
+/* ========== HELPER							==========	*/
+static void vhSpawnDestroyAll(vPObject* objects)
+{
+	for (vUI32 i = 0; i < SPAWN_OBJECTS; i++)
+		vDestroyObject(objects[i]);
+}
+
+static double vhSpawnRunSingle(vPUI16 components, vPObject* objects)
+{
+	double seconds = 0.0;
+	for (int round = 0; round < SPAWN_ROUNDS; round++)
+	{
+		LARGE_INTEGER start = vbTimerStart();
+		for (vUI32 i = 0; i < SPAWN_OBJECTS; i++)
+		{
+			objects[i] = vCreateObject(NULL);
+			for (int c = 0; c < SPAWN_COMPONENTS; c++)
+				vObjectAddComponent(objects[i], components[c], NULL);
+		}
+		seconds += vbTimerSeconds(start);
+
+		vhSpawnDestroyAll(objects);
+	}
+	return seconds;
+}
+
+static double vhSpawnRunPrefab(vPUI16 components, vPObject* objects)
+{
+	vHNDL prefab = vCreatePrefab("Spawn Bench Prefab");
+	vUI64 attributeTemplate[2] = { 1, 2 };
+	for (int c = 0; c < SPAWN_COMPONENTS; c++)
+		vPrefabAddComponent(prefab, components[c], attributeTemplate);
+
+	double seconds = 0.0;
+	for (int round = 0; round < SPAWN_ROUNDS; round++)
+	{
+		LARGE_INTEGER start = vbTimerStart();
+		vInstantiatePrefab(prefab, SPAWN_OBJECTS, objects);
+		seconds += vbTimerSeconds(start);
+
+		vhSpawnDestroyAll(objects);
+	}
+
+	vDestroyPrefab(prefab);
+	return seconds;
+}
+
+
+/* ========== BENCHMARK							==========	*/
+void vbSpawn(void)
+{
+	vUI16 components[SPAWN_COMPONENTS];
+	for (int c = 0; c < SPAWN_COMPONENTS; c++)
+	{
+		vCHAR name[BUFF_SMALL];
+		sprintf_s(name, sizeof(name), "Spawn Bench Component %d", c);
+		components[c] = vCreateComponent(name, 0, sizeof(vUI64) * 2, NULL, NULL,
+			NULL, NULL, NULL);
+	}
+
+	/* one op is one component placed on a new object */
+	vPObject* objects = vAlloc(sizeof(vPObject) * SPAWN_OBJECTS);
+	vUI64 operations = (vUI64)SPAWN_ROUNDS * SPAWN_OBJECTS * SPAWN_COMPONENTS;
+	vbReport(__func__, "create + add component", operations,
+		vhSpawnRunSingle(components, objects));
+	vbReport(__func__, "instantiate prefab", operations,
+		vhSpawnRunPrefab(components, objects));
+	vFree(objects);
+}
@@ -0,0 +1,422 @@
+
+/* ========== <varchetype.c>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "varchetype.h"
+#include <intrin.h>
+
+
+/* ========== HELPER							==========	*/
+static __forceinline vI32 vhArchetypeColumnIndex(vPArchetype archetype, vUI16 component)
+{
+	if (archetype == NULL) return -1;
+
+	for (vI32 i = 0; i < archetype->componentCount; i++)
+	{
+		if (archetype->components[i] == component) return i;
+	}
+
+	return -1;
+}
+
+static __forceinline vBOOL vhSignatureEmpty(vPUI64 signature)
+{
+	for (int i = 0; i < COMPONENT_SIGNATURE_WORDS; i++)
+	{
+		if (signature[i] != 0) return FALSE;
+	}
+	return TRUE;
+}
+
+static __forceinline vUI64 vhAlignColumn(vUI64 offset)
+{
+	return (offset + ARCHETYPE_COLUMN_ALIGNMENT - 1) & ~(vUI64)(ARCHETYPE_COLUMN_ALIGNMENT - 1);
+}
+
+static vPArchetype vhFindArchetype(vPUI64 signature)
+{
+	/* look for an existing archetype with the same set */
+	vPArchetype freeArchetype = NULL;
+	for (int i = 0; i < MAX_ARCHETYPES; i++)
+	{
+		vPArchetype archetype = _vcore.archetypes + i;
+		if (archetype->inUse == FALSE)
+		{
+			if (freeArchetype == NULL) freeArchetype = archetype;
+			continue;
+		}
+
+		if (memcmp(archetype->signature, signature, sizeof(archetype->signature)) == 0)
+			return archetype;
+	}
+
+	/* emptied archetypes are recycled, so this only happens	*/
+	/* with MAX_ARCHETYPES distinct sets alive at once			*/
+	if (freeArchetype == NULL)
+	{
+		vLogError(__func__, "Could not create more archetypes. "
+			"Max archetypes have been created.");
+		return NULL;
+	}
+
+	/* create archetype, columns are in ascending handle order */
+	vPArchetype archetype = freeArchetype;
+	vZeroMemory(archetype, sizeof(vArchetype));
+	vMemCopy(archetype->signature, signature, sizeof(archetype->signature));
+
+	vUI64 rowBytes = sizeof(vPObject);
+	for (int i = 0; i < COMPONENT_SIGNATURE_WORDS; i++)
+	{
+		vUI64 word = signature[i];
+		while (word != 0)
+		{
+			unsigned long bit;
+			_BitScanForward64(&bit, word);
+			word &= word - 1;
+
+			vUI16 component = (i << 0x06) + bit;
+			vUI64 columnSize = max(4, _vcore.components[component].objectAttributeSize);
+			archetype->components[archetype->componentCount]  = component;
+			archetype->columnSizes[archetype->componentCount] = columnSize;
+			archetype->componentCount++;
+			rowBytes += columnSize;
+		}
+	}
+
+	archetype->rowsPerChunk = max(1, ARCHETYPE_CHUNK_BYTES / rowBytes);
+	archetype->inUse = TRUE;
+
+	vLogInfoFormatted(__func__, "Created archetype with %d components "
+		"and %d rows per chunk.", archetype->componentCount, archetype->rowsPerChunk);
+
+	return archetype;
+}
+
+static vPArchetypeChunk vhCreateArchetypeChunk(vPArchetype archetype)
+{
+	/* layout is header, row owners, then each column */
+	vUI64 rows = archetype->rowsPerChunk;
+	vUI64 objectsOffset = vhAlignColumn(sizeof(vArchetypeChunk));
+	vUI64 columnOffset  = vhAlignColumn(objectsOffset + (rows * sizeof(vPObject)));
+	vUI64 totalBytes	= columnOffset;
+	for (int i = 0; i < archetype->componentCount; i++)
+		totalBytes = vhAlignColumn(totalBytes + (rows * archetype->columnSizes[i]));
+
+	vPBYTE block = vAllocZeroed(totalBytes);
+	vPArchetypeChunk chunk = (vPArchetypeChunk)block;
+	chunk->objects = (vPObject*)(block + objectsOffset);
+	for (int i = 0; i < archetype->componentCount; i++)
+	{
+		chunk->columns[i] = block + columnOffset;
+		columnOffset = vhAlignColumn(columnOffset + (rows * archetype->columnSizes[i]));
+	}
+
+	return chunk;
+}
+
+static __forceinline vPTR vhArchetypeCell(vPArchetype archetype, vUI64 row, vI32 column)
+{
+	vPArchetypeChunk chunk = archetype->chunks[row / archetype->rowsPerChunk];
+	return chunk->columns[column] +
+		((row % archetype->rowsPerChunk) * archetype->columnSizes[column]);
+}
+
+static __forceinline vPObject* vhArchetypeRowOwner(vPArchetype archetype, vUI64 row)
+{
+	vPArchetypeChunk chunk = archetype->chunks[row / archetype->rowsPerChunk];
+	return chunk->objects + (row % archetype->rowsPerChunk);
+}
+
+static void vhArchetypeRebind(vPObject object)
+{
+	/* point every live component at its column cell */
+	for (int i = 0; i < VOBJECT_MAX_COMPONENTS; i++)
+	{
+		vPComponent comp = object->components + i;
+		if (comp->objectAttribute == NULL) continue;
+
+		vI32 column = vhArchetypeColumnIndex(object->archetype, comp->componentDescriptorHandle);
+		if (column < 0) continue;
+
+		comp->objectAttribute = vhArchetypeCell(object->archetype, object->archetypeRow, column);
+	}
+}
+
+static vUI64 vhArchetypeAllocRow(vPArchetype archetype, vPObject object)
+{
+	/* append chunk when all chunks are full */
+	if (archetype->rowCount == (vUI64)archetype->chunkCount * archetype->rowsPerChunk)
+	{
+		if (archetype->chunkCount == archetype->chunkCapacity)
+		{
+			vUI32 newCapacity = max(4, archetype->chunkCapacity << 1);
+			vPArchetypeChunk* newChunks = vAllocZeroed(sizeof(vPArchetypeChunk) * newCapacity);
+			if (archetype->chunks)
+			{
+				vMemCopy(newChunks, archetype->chunks,
+					sizeof(vPArchetypeChunk) * archetype->chunkCount);
+				vFree(archetype->chunks);
+			}
+			archetype->chunks		 = newChunks;
+			archetype->chunkCapacity = newCapacity;
+		}
+
+		archetype->chunks[archetype->chunkCount++] = vhCreateArchetypeChunk(archetype);
+	}
+
+	vUI64 row = archetype->rowCount++;
+	archetype->chunks[row / archetype->rowsPerChunk]->rowCount++;
+	*vhArchetypeRowOwner(archetype, row) = object;
+
+	return row;
+}
+
+static void vhArchetypeFreeRow(vPArchetype archetype, vUI64 row)
+{
+	/* move last row into the hole to keep rows dense */
+	vUI64 last = archetype->rowCount - 1;
+	if (row != last)
+	{
+		for (int i = 0; i < archetype->componentCount; i++)
+			vMemCopy(vhArchetypeCell(archetype, row, i), vhArchetypeCell(archetype, last, i),
+				archetype->columnSizes[i]);
+
+		vPObject moved = *vhArchetypeRowOwner(archetype, last);
+		*vhArchetypeRowOwner(archetype, row) = moved;
+		moved->archetypeRow = row;
+		vhArchetypeRebind(moved);
+	}
+
+	*vhArchetypeRowOwner(archetype, last) = NULL;
+	archetype->rowCount--;
+
+	/* free tail chunk once it is empty */
+	vPArchetypeChunk tail = archetype->chunks[last / archetype->rowsPerChunk];
+	if (--tail->rowCount == 0)
+	{
+		vFree(tail);
+		archetype->chunks[--archetype->chunkCount] = NULL;
+	}
+
+	/* release the archetype with its last row, so sets only	*/
+	/* passed through on the way to another do not pile up		*/
+	if (archetype->rowCount == 0)
+	{
+		if (archetype->chunks) vFree(archetype->chunks);
+		vZeroMemory(archetype, sizeof(vArchetype));
+	}
+}
+
+static vBOOL vhArchetypeMoveObject(vPObject object, vPUI64 signature)
+{
+	vPArchetype source = object->archetype;
+	vUI64 sourceRow = object->archetypeRow;
+
+	/* empty component set means the object has no row */
+	vPArchetype target = NULL;
+	if (vhSignatureEmpty(signature) == FALSE)
+	{
+		target = vhFindArchetype(signature);
+		if (target == NULL) return FALSE;
+	}
+	vUI64 targetRow = 0;
+	if (target != NULL)
+	{
+		targetRow = vhArchetypeAllocRow(target, object);
+
+		/* carry over shared columns, zero new ones */
+		for (int i = 0; i < target->componentCount; i++)
+		{
+			vPTR cell = vhArchetypeCell(target, targetRow, i);
+			vI32 sourceColumn = vhArchetypeColumnIndex(source, target->components[i]);
+			if (sourceColumn >= 0)
+				vMemCopy(cell, vhArchetypeCell(source, sourceRow, sourceColumn),
+					target->columnSizes[i]);
+			else
+				vZeroMemory(cell, target->columnSizes[i]);
+		}
+	}
+
+	if (source != NULL) vhArchetypeFreeRow(source, sourceRow);
+
+	object->archetype	 = target;
+	object->archetypeRow = targetRow;
+	vhArchetypeRebind(object);
+
+	return TRUE;
+}
+
+static __forceinline void vhObjectSignature(vPObject object, vPUI64 signatureOut)
+{
+	/* taken from the object, its archetype may be a superset	*/
+	/* if an earlier move could not be made					*/
+	vMemCopy(signatureOut, object->componentSignature,
+		sizeof(vUI64) * COMPONENT_SIGNATURE_WORDS);
+}
+
+
+/* ========== SYNCHRONIZATION					==========	*/
+VAPI void vArchetypeLock(void)
+{
+	vRWLockExclusive(&_vcore.archetypeLock);
+}
+
+VAPI void vArchetypeUnlock(void)
+{
+	vRWUnlockExclusive(&_vcore.archetypeLock);
+}
+
+VAPI void vArchetypeLockShared(void)
+{
+	vRWLockShared(&_vcore.archetypeLock);
+}
+
+VAPI void vArchetypeUnlockShared(void)
+{
+	vRWUnlockShared(&_vcore.archetypeLock);
+}
+
+VAPI vBOOL vArchetypeLockHeldShared(void)
+{
+	return vRWLockHeldShared(&_vcore.archetypeLock);
+}
+
+
+/* ========== OBJECT STORAGE					==========	*/
+VAPI vPTR vArchetypeObjectAddComponent(vPObject object, vUI16 component)
+{
+	vArchetypeLock(); /* SYNC */
+
+	vUI64 signature[COMPONENT_SIGNATURE_WORDS];
+	vhObjectSignature(object, signature);
+	_bittestandset64(signature + (component >> 0x06), component & 0x3F);
+
+	/* move to new archetype and return the new cell */
+	vPTR attribute = NULL;
+	if (vhArchetypeMoveObject(object, signature))
+	{
+		attribute = vhArchetypeCell(object->archetype, object->archetypeRow,
+			vhArchetypeColumnIndex(object->archetype, component));
+	}
+
+	vArchetypeUnlock(); /* UNSYNC */
+
+	return attribute;
+}
+
+VAPI vBOOL vArchetypeObjectRemoveComponent(vPObject object, vUI16 component)
+{
+	vArchetypeLock(); /* SYNC */
+
+	vUI64 signature[COMPONENT_SIGNATURE_WORDS];
+	vhObjectSignature(object, signature);
+	_bittestandreset64(signature + (component >> 0x06), component & 0x3F);
+
+	/* on failure the object keeps its row, the column is unused */
+	vBOOL moved = vhArchetypeMoveObject(object, signature);
+	if (moved == FALSE)
+	{
+		vLogWarningFormatted(__func__, "Object '%p' kept its archetype row after "
+			"removing component '%d'.", object, component);
+	}
+
+	vArchetypeUnlock(); /* UNSYNC */
+
+	return moved;
+}
+
+VAPI void vArchetypeObjectRelease(vPObject object)
+{
+	vArchetypeLock(); /* SYNC */
+
+	if (object->archetype != NULL)
+	{
+		vhArchetypeFreeRow(object->archetype, object->archetypeRow);
+		object->archetype	 = NULL;
+		object->archetypeRow = 0;
+	}
+
+	vArchetypeUnlock(); /* UNSYNC */
+}
+
+VAPI vBOOL vArchetypeObjectPlace(vPObject object, vPUI64 signature)
+{
+	/* one move straight to the archetype of the full set */
+	vArchetypeLock(); /* SYNC */
+	vBOOL moved = vhArchetypeMoveObject(object, signature);
+	vArchetypeUnlock(); /* UNSYNC */
+
+	return moved;
+}
+
+VAPI vPTR vArchetypeObjectGetAttribute(vPObject object, vUI16 component)
+{
+	vI32 column = vhArchetypeColumnIndex(object->archetype, component);
+	if (column < 0) return NULL;
+	return vhArchetypeCell(object->archetype, object->archetypeRow, column);
+}
+
+
+/* ========== ITERATION							==========	*/
+VAPI void vArchetypeIterateComponent(vUI16 component, vPFARCHETYPECOLUMNFUNC function,
+	vPTR input)
+{
+	if (function == NULL)
+	{
+		vLogWarning(__func__, "Tried to iterate over archetypes with NULL function.");
+		return;
+	}
+
+	vArchetypeLockShared(); /* SYNC */
+
+	/* hand out one contiguous column per chunk */
+	for (int i = 0; i < MAX_ARCHETYPES; i++)
+	{
+		vPArchetype archetype = _vcore.archetypes + i;
+		if (archetype->inUse == FALSE) continue;
+
+		vI32 column = vhArchetypeColumnIndex(archetype, component);
+		if (column < 0) continue;
+
+		for (vUI32 j = 0; j < archetype->chunkCount; j++)
+		{
+			vPArchetypeChunk chunk = archetype->chunks[j];
+			function(component, chunk->columns[column], chunk->objects,
+				chunk->rowCount, input);
+		}
+	}
+
+	vArchetypeUnlockShared(); /* UNSYNC */
+}
+
+
+/* ========== ARCHETYPE INFORMATION				==========	*/
+VAPI vUI32 vArchetypeGetCount(void)
+{
+	vUI32 count = 0;
+	for (int i = 0; i < MAX_ARCHETYPES; i++)
+	{
+		if (_vcore.archetypes[i].inUse) count++;
+	}
+	return count;
+}
+
+VAPI vUI64 vArchetypeGetComponentRowCount(vUI16 component)
+{
+	vArchetypeLockShared(); /* SYNC */
+
+	vUI64 rows = 0;
+	for (int i = 0; i < MAX_ARCHETYPES; i++)
+	{
+		vPArchetype archetype = _vcore.archetypes + i;
+		if (archetype->inUse == FALSE) continue;
+		if (vhArchetypeColumnIndex(archetype, component) < 0) continue;
+		rows += archetype->rowCount;
+	}
+
+	vArchetypeUnlockShared(); /* UNSYNC */
+
+	return rows;
+}
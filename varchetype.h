@@ -0,0 +1,45 @@
+
+/* ========== <varchetype.h>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Archetype (struct of arrays) object attribute storage	*/
+
+#ifndef _VCORE_ARCHETYPE_INCLUDE_
+#define _VCORE_ARCHETYPE_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+
+
+/* ========== SYNCHRONIZATION					==========	*/
+/* moving an object between archetypes relocates other rows	*/
+/* and rebinds their attribute pointers under this lock, so	*/
+/* attribute pointers are only valid while it is held shared.	*/
+/* component cycles run with it held shared, so they must		*/
+/* defer structural changes through their worker's commands	*/
+VAPI void vArchetypeLock(void);
+VAPI void vArchetypeUnlock(void);
+VAPI void vArchetypeLockShared(void);
+VAPI void vArchetypeUnlockShared(void);
+VAPI vBOOL vArchetypeLockHeldShared(void);
+
+
+/* ========== OBJECT STORAGE					==========	*/
+/* add and place return NULL or FALSE, leaving the object	*/
+/* where it was, when no archetype is left for the new set	*/
+VAPI vPTR  vArchetypeObjectAddComponent(vPObject object, vUI16 component);
+VAPI vBOOL vArchetypeObjectRemoveComponent(vPObject object, vUI16 component);
+VAPI void  vArchetypeObjectRelease(vPObject object);
+VAPI vBOOL vArchetypeObjectPlace(vPObject object, vPUI64 signature);
+VAPI vPTR  vArchetypeObjectGetAttribute(vPObject object, vUI16 component);
+
+
+/* ========== ITERATION							==========	*/
+VAPI void vArchetypeIterateComponent(vUI16 component, vPFARCHETYPECOLUMNFUNC function,
+	vPTR input);
+
+
+/* ========== ARCHETYPE INFORMATION				==========	*/
+VAPI vUI32 vArchetypeGetCount(void);
+VAPI vUI64 vArchetypeGetComponentRowCount(vUI16 component);
+
+#endif
@@ -6,6 +6,7 @@
 /* ========== INCLUDES							==========	*/
 #include "vbuffers.h"
 #include <intrin.h>
+#include <stdlib.h>
 
 
 /* ========== HELPER							==========	*/
@@ -41,6 +42,423 @@ static __forceinline vUI16 vhMapPtrToBufferIndex(vPBuffer buffer, vPTR ptr)
 	return ((vPBYTE)ptr - buffer->data) / buffer->elementSizeBytes;
 }
 
+static __forceinline vUI64 vhBufferFieldWordCount(vPBuffer buffer)
+{
+	/* only the words which cover capacity are ever searched */
+	return ((vUI64)buffer->capacity + 0x3F) >> 0x06;
+}
+
+static __forceinline vUI64 vhBufferFreeMask(vPBuffer buffer, vUI64 chunk, vUI64 word)
+{
+	vUI64 freeMask = ~word;
+
+	/* mask out bits past capacity in the last word */
+	vUI64 tailBits = buffer->capacity & 0b111111;
+	if (tailBits != 0 && chunk == (buffer->capacity >> 0x06))
+		freeMask &= (1ULL << tailBits) - 1;
+
+	return freeMask;
+}
+
+static __forceinline vUI64 vhFindFreeBufferSlot(vPBuffer buffer)
+{
+	vUI64 wordCount  = vhBufferFieldWordCount(buffer);
+	vUI64 startChunk = buffer->searchHint;
+	if (startChunk >= wordCount) startChunk = 0;
+
+	/* walk whole words starting at the hint, wrapping around once */
+	for (vUI64 i = 0; i < wordCount; i++)
+	{
+		vUI64 chunk = startChunk + i;
+		if (chunk >= wordCount) chunk -= wordCount;
+
+		/* inverted word has a set bit for every free slot */
+		vUI64 freeMask = vhBufferFreeMask(buffer, chunk, buffer->useField[chunk]);
+		if (freeMask == 0) continue;
+
+		unsigned long bit;
+		_BitScanForward64(&bit, freeMask);
+
+		/* this word may still have free slots, start here next time */
+		buffer->searchHint = chunk;
+
+		return vhMapUseFieldToIndex(chunk, bit);
+	}
+
+	/* on nothing found, return -1 */
+	return ~0ULL;
+}
+
+static __forceinline vUI64 vhLowestBits(vUI64 mask, vUI64 count)
+{
+	/* keep only the lowest count set bits of mask */
+	if (__popcnt64(mask) <= count) return mask;
+
+	vUI64 result = 0;
+	for (vUI64 i = 0; i < count; i++)
+	{
+		vUI64 lowBit = mask & (~mask + 1);
+		result |= lowBit;
+		mask   ^= lowBit;
+	}
+	return result;
+}
+
+static __forceinline vUI64 vhClaimFreeBufferRun(vPBuffer buffer, vUI64 maxCount,
+	vPUI64 chunkOut, vBOOL atomic)
+{
+	vUI64 wordCount  = vhBufferFieldWordCount(buffer);
+	vUI64 startChunk = buffer->searchHint;
+	if (startChunk >= wordCount) startChunk = 0;
+
+	for (vUI64 i = 0; i < wordCount; i++)
+	{
+		vUI64 chunk = startChunk + i;
+		if (chunk >= wordCount) chunk -= wordCount;
+
+		volatile vI64* wordPtr = (volatile vI64*)(buffer->useField + chunk);
+
+		/* keep trying this word until it is full or bits are won */
+		while (TRUE)
+		{
+			vUI64 word = *wordPtr;
+			vUI64 freeMask = vhBufferFreeMask(buffer, chunk, word);
+			if (freeMask == 0) break;
+
+			vUI64 claimMask = vhLowestBits(freeMask, maxCount);
+
+			/* publish claim. on lost race, retry with fresh word */
+			if (atomic)
+			{
+				if (_InterlockedCompareExchange64(wordPtr, word | claimMask, word) != word)
+					continue;
+			}
+			else
+			{
+				*wordPtr = word | claimMask;
+			}
+
+			buffer->searchHint = chunk;
+			*chunkOut = chunk;
+			return claimMask;
+		}
+	}
+
+	/* on nothing found, return empty mask */
+	return 0;
+}
+
+static __forceinline vUI64 vhClaimFreeBufferSlotLockFree(vPBuffer buffer)
+{
+	vUI64 chunk;
+	vUI64 claimMask = vhClaimFreeBufferRun(buffer, 1, &chunk, TRUE);
+	if (claimMask == 0) return ~0ULL;
+
+	unsigned long bit;
+	_BitScanForward64(&bit, claimMask);
+	return vhMapUseFieldToIndex(chunk, bit);
+}
+
+static __forceinline void vhBufferZeroRuns(vPBuffer buffer, vUI64 chunk, vUI64 mask)
+{
+	/* zero each run of contiguous slots with a single store */
+	while (mask != 0)
+	{
+		unsigned long start;
+		_BitScanForward64(&start, mask);
+
+		vUI64 shifted = ~(mask >> start);
+		unsigned long runLength = 64 - start;
+		if (shifted != 0) _BitScanForward64(&runLength, shifted);
+
+		vUI64 index = vhMapUseFieldToIndex(chunk, start);
+		vZeroMemory(buffer->data + (index * buffer->elementSizeBytes),
+			(vUI64)runLength * buffer->elementSizeBytes);
+
+		if (start + runLength >= 64) break;
+		mask &= ~0ULL << (start + runLength);
+	}
+}
+
+static __forceinline vPUI64 vhBufferLiveField(vPBuffer buffer)
+{
+	/* lock-free buffers track reserved and initialized slots seperately */
+	return (buffer->liveField != NULL) ? buffer->liveField : buffer->useField;
+}
+
+static __forceinline vPTR vhBufferAddLockFree(vHNDL buffHndl, vPBuffer buff, vPTR input)
+{
+	vUI64 index = vhClaimFreeBufferSlotLockFree(buff);
+	if (index == ~0ULL)
+	{
+		vLogWarning(__func__, "Buffer has no more free elements.");
+		vCoreFatalError(__func__, "Buffer has run out of free elements.");
+	}
+
+	/* slot is owned exclusively by this thread from here on */
+	_InterlockedIncrement16((volatile short*)&buff->elementsUsed);
+
+	vPTR elemPtr = buff->data + (index * buff->elementSizeBytes);
+	vZeroMemory(elemPtr, buff->elementSizeBytes);
+
+	if (buff->initializeFunc)
+		buff->initializeFunc(buffHndl, index, elemPtr, input);
+
+	/* mark as live only once fully initialized */
+	vUI64 chunk, bit;
+	vhMapIndexToUseField(index, &chunk, &bit);
+	_interlockedbittestandset64(buff->liveField + chunk, bit);
+
+	return elemPtr;
+}
+
+static __forceinline void vhBufferRemoveLockFree(vHNDL buffHndl, vPBuffer buff, 
+	vUI16 index)
+{
+	vUI64 chunk, bit;
+	vhMapIndexToUseField(index, &chunk, &bit);
+
+	/* clearing the live bit first guarantees one destroy per element */
+	if (_interlockedbittestandreset64(buff->liveField + chunk, bit) == FALSE)
+	{
+		vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+		return;
+	}
+
+	if (buff->destroyFunc)
+		buff->destroyFunc(buffHndl, index, buff->data + (index * buff->elementSizeBytes));
+
+	/* slot can only be re-claimed once destruction is complete */
+	_interlockedbittestandreset64(buff->useField + chunk, bit);
+	_InterlockedDecrement16((volatile short*)&buff->elementsUsed);
+	buff->searchHint = chunk;
+}
+
+/* lock order is always buffer lock, then magazine lock.	*/
+/* locked buffers keep the shared field under the buffer	*/
+/* lock, lock-free buffers only ever touch it atomically	*/
+static __forceinline void vhBufferMagazineSharedLock(vPBuffer buff)
+{
+	if ((buff->flags & BUFFER_FLAG_LOCKFREE) == FALSE)
+		vRWLockExclusive(&buff->rwPermission);
+}
+
+static __forceinline void vhBufferMagazineSharedUnlock(vPBuffer buff)
+{
+	if ((buff->flags & BUFFER_FLAG_LOCKFREE) == FALSE)
+		vRWUnlockExclusive(&buff->rwPermission);
+}
+
+static void vhBufferMagazineRefill(vPBuffer buff, vPBufferMagazine mag)
+{
+	/* reserve half a magazine so the next few frees fit locally */
+	while (mag->count < (BUFFER_MAGAZINE_SIZE >> 1))
+	{
+		vUI64 index = vhClaimFreeBufferSlotLockFree(buff);
+		if (index == ~0ULL) break;
+		mag->indices[mag->count++] = index;
+	}
+}
+
+static void vhBufferMagazineDrain(vPBuffer buff, vPBufferMagazine mag, vUI16 keepCount)
+{
+	/* return all but keepCount slots to the shared field */
+	while (mag->count > keepCount)
+	{
+		vUI64 chunk, bit;
+		vhMapIndexToUseField(mag->indices[--mag->count], &chunk, &bit);
+		_interlockedbittestandreset64(buff->useField + chunk, bit);
+		buff->searchHint = chunk;
+	}
+}
+
+static void NTAPI vhBufferMagazineThreadExit(vPTR threadMagazines)
+{
+	vPBufferMagazine mag = threadMagazines;
+	while (mag != NULL)
+	{
+		vPBufferMagazine next = mag->nextInThread;
+		vPBuffer owner = mag->owner;
+
+		/* give cached slots back and unlink from owner */
+		if (owner != NULL)
+		{
+			vRWLockExclusive(&owner->rwPermission);
+
+			AcquireSRWLockExclusive(&mag->lock);
+			vhBufferMagazineDrain(owner, mag, 0);
+			mag->owner = NULL;
+			ReleaseSRWLockExclusive(&mag->lock);
+
+			vPBufferMagazine* link = &owner->magazines;
+			while (*link != NULL && *link != mag) link = &(*link)->nextInBuffer;
+			if (*link == mag) *link = mag->nextInBuffer;
+
+			vRWUnlockExclusive(&owner->rwPermission);
+		}
+
+		vFree(mag);
+		mag = next;
+	}
+}
+
+static vPBufferMagazine vhGetThreadMagazine(vPBuffer buff)
+{
+	vPBufferMagazine head = FlsGetValue(_vcore.magazineFls);
+
+	/* find this buffer's magazine, dropping orphans along the way */
+	vPBufferMagazine* link = &head;
+	while (*link != NULL)
+	{
+		vPBufferMagazine mag = *link;
+		if (mag->owner == buff)
+		{
+			FlsSetValue(_vcore.magazineFls, head);
+			return mag;
+		}
+
+		if (mag->owner == NULL)
+		{
+			*link = mag->nextInThread;
+			vFree(mag);
+			continue;
+		}
+
+		link = &mag->nextInThread;
+	}
+
+	/* create and register a new magazine for this thread */
+	vPBufferMagazine mag = vAllocZeroed(sizeof(vBufferMagazine));
+	InitializeSRWLock(&mag->lock);
+	mag->owner = buff;
+	mag->nextInThread = head;
+	FlsSetValue(_vcore.magazineFls, mag);
+
+	vRWLockExclusive(&buff->rwPermission);
+	mag->nextInBuffer = buff->magazines;
+	buff->magazines   = mag;
+	vRWUnlockExclusive(&buff->rwPermission);
+
+	return mag;
+}
+
+static __forceinline vPTR vhBufferAddMagazine(vHNDL buffHndl, vPBuffer buff, vPTR input)
+{
+	vPBufferMagazine mag = vhGetThreadMagazine(buff);
+
+	/* fast path, slot is already cached locally */
+	AcquireSRWLockExclusive(&mag->lock);
+	if (mag->count == 0)
+	{
+		/* re-take in lock order and refill from shared field */
+		ReleaseSRWLockExclusive(&mag->lock);
+		vhBufferMagazineSharedLock(buff);
+		AcquireSRWLockExclusive(&mag->lock);
+		if (mag->count == 0) vhBufferMagazineRefill(buff, mag);
+		vhBufferMagazineSharedUnlock(buff);
+	}
+	if (mag->count == 0)
+	{
+		ReleaseSRWLockExclusive(&mag->lock);
+		vLogWarning(__func__, "Buffer has no more free elements.");
+		vCoreFatalError(__func__, "Buffer has run out of free elements.");
+	}
+	vUI16 index = mag->indices[--mag->count];
+	ReleaseSRWLockExclusive(&mag->lock);
+
+	_InterlockedIncrement16((volatile short*)&buff->elementsUsed);
+
+	vPTR elemPtr = buff->data + (index * buff->elementSizeBytes);
+	vZeroMemory(elemPtr, buff->elementSizeBytes);
+
+	if (buff->initializeFunc)
+		buff->initializeFunc(buffHndl, index, elemPtr, input);
+
+	vUI64 chunk, bit;
+	vhMapIndexToUseField(index, &chunk, &bit);
+	_interlockedbittestandset64(buff->liveField + chunk, bit);
+
+	return elemPtr;
+}
+
+static __forceinline void vhBufferRemoveMagazine(vHNDL buffHndl, vPBuffer buff,
+	vUI16 index)
+{
+	vUI64 chunk, bit;
+	vhMapIndexToUseField(index, &chunk, &bit);
+
+	if (_interlockedbittestandreset64(buff->liveField + chunk, bit) == FALSE)
+	{
+		vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+		return;
+	}
+
+	if (buff->destroyFunc)
+		buff->destroyFunc(buffHndl, index, buff->data + (index * buff->elementSizeBytes));
+	_InterlockedDecrement16((volatile short*)&buff->elementsUsed);
+
+	/* keep slot reserved in this thread's magazine */
+	vPBufferMagazine mag = vhGetThreadMagazine(buff);
+	AcquireSRWLockExclusive(&mag->lock);
+	if (mag->count >= BUFFER_MAGAZINE_SIZE)
+	{
+		/* re-take in lock order and spill half to shared field */
+		ReleaseSRWLockExclusive(&mag->lock);
+		vhBufferMagazineSharedLock(buff);
+		AcquireSRWLockExclusive(&mag->lock);
+		if (mag->count >= BUFFER_MAGAZINE_SIZE)
+			vhBufferMagazineDrain(buff, mag, BUFFER_MAGAZINE_SIZE >> 1);
+		vhBufferMagazineSharedUnlock(buff);
+	}
+	mag->indices[mag->count++] = index;
+	ReleaseSRWLockExclusive(&mag->lock);
+}
+
+static __forceinline void vhBufferMoveElement(vHNDL buffHndl, vPBuffer buff,
+	vUI64 oldIndex, vUI64 newIndex)
+{
+	vPBYTE newPtr = buff->data + (newIndex * buff->elementSizeBytes);
+	vMemCopy(newPtr, buff->data + (oldIndex * buff->elementSizeBytes),
+		buff->elementSizeBytes);
+
+	/* let owner fix up references */
+	if (buff->relocateFunc)
+		buff->relocateFunc(buffHndl, oldIndex, newIndex, newPtr);
+}
+
+static void vhBufferRemoveLocked(vHNDL buffHndl, vPBuffer buff, vUI16 index)
+{
+	/* check if spot is already removed */
+	vUI64 chunk, bit = 0;
+	vhMapIndexToUseField(index, &chunk, &bit);
+	if (_bittest64(&buff->useField[chunk], bit) == FALSE)
+	{
+		vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+		return;
+	}
+
+	/* call destruction function (if exists) */
+	if (buff->destroyFunc)
+		buff->destroyFunc(buffHndl, index, 
+			(vPBYTE)buff->data + (index * buff->elementSizeBytes));
+
+	/* dense buffers fill the hole with the last element */
+	if (buff->flags & BUFFER_FLAG_DENSE)
+	{
+		vUI64 lastIndex = buff->elementsUsed - 1;
+		if (index != lastIndex)
+			vhBufferMoveElement(buffHndl, buff, lastIndex, index);
+		vhMapIndexToUseField(lastIndex, &chunk, &bit);
+	}
+
+	/* reset bit and decrement use count */
+	_bittestandreset64(&buff->useField[chunk], bit);
+	buff->elementsUsed--;
+
+	/* freed word is guaranteed to have a free slot */
+	buff->searchHint = chunk;
+}
+
 static __forceinline vPBuffer vhGetBufferLocked(vHNDL bufHndl)
 {
 	/* SYNC		*/ vCoreLock();
@@ -49,10 +467,55 @@ static __forceinline vPBuffer vhGetBufferLocked(vHNDL bufHndl)
 	return buff;
 }
 
+static void vhBufferIterateChunk(vPBufferIterateChunk chunk)
+{
+	vPBuffer buff = _vcore.buffers + chunk->buffer;
+
+	/* dense buffers are split by element */
+	if (buff->flags & BUFFER_FLAG_DENSE)
+	{
+		for (vUI64 i = chunk->rangeStart; i < chunk->rangeEnd; i++)
+			chunk->function(chunk->buffer, i, buff->data + (i * buff->elementSizeBytes),
+				chunk->input, chunk->chunkData);
+		return;
+	}
+
+	/* others by use field word, walking set bits */
+	vPUI64 liveField = vhBufferLiveField(buff);
+	for (vUI64 chunkIndex = chunk->rangeStart; chunkIndex < chunk->rangeEnd; chunkIndex++)
+	{
+		vUI64 live = liveField[chunkIndex];
+		while (live != 0)
+		{
+			unsigned long bit;
+			_BitScanForward64(&bit, live);
+			live &= live - 1;
+
+			vUI64 index = vhMapUseFieldToIndex(chunkIndex, bit);
+			chunk->function(chunk->buffer, index, buff->data + (index * buff->elementSizeBytes),
+				chunk->input, chunk->chunkData);
+		}
+	}
+}
+
+static void vhBufferIterateChunkTask(vPWorker worker, vPTR persistentData,
+	vPBufferIterateChunk chunk)
+{
+	vhBufferIterateChunk(chunk);
+}
+
 /* ========== CREATION AND DESTRUCTION			==========	*/
 VAPI vHNDL vCreateBuffer(const char* bufferName, vUI16 elementSize,
 	vUI16 capacity, vPFBUFFERINITIALIZEELEMENT initializeFunc,
 	vPFBUFFERDESTROYELEMENT destroyFunc)
+{
+	return vCreateBufferEx(bufferName, elementSize, capacity, initializeFunc,
+		destroyFunc, NO_FLAGS);
+}
+
+VAPI vHNDL vCreateBufferEx(const char* bufferName, vUI16 elementSize,
+	vUI16 capacity, vPFBUFFERINITIALIZEELEMENT initializeFunc,
+	vPFBUFFERDESTROYELEMENT destroyFunc, vBYTE flags)
 {
 	/* SYNC		*/ vCoreLock();
 
@@ -72,18 +535,49 @@ VAPI vHNDL vCreateBuffer(const char* bufferName, vUI16 elementSize,
 	}
 
 	/* initialize element related data */
-	InitializeCriticalSection(&buffer->rwPermission);
+	vRWLockInitialize(&buffer->rwPermission);
 	vCoreTime(&buffer->timeCreated);
 	buffer->elementSizeBytes = elementSize;
 	buffer->capacity	= capacity;
 	buffer->sizeBytes   = buffer->elementSizeBytes * buffer->capacity;
+	buffer->flags		= flags;
 	buffer->inUse		= TRUE;
 
+	/* dense packing needs every add and remove under the buffer lock */
+	if ((buffer->flags & BUFFER_FLAG_DENSE) &&
+		(buffer->flags & (BUFFER_FLAG_LOCKFREE | BUFFER_FLAG_MAGAZINE)))
+	{
+		vLogWarning(__func__, "Dense buffers cannot be lock-free or use magazines, "
+			"buffer will not be dense.");
+		buffer->flags &= ~BUFFER_FLAG_DENSE;
+	}
+
+	/* magazines need a thread exit hook to return cached slots */
+	if ((buffer->flags & BUFFER_FLAG_MAGAZINE) && _vcore.magazineFlsReady == FALSE)
+	{
+		_vcore.magazineFls = FlsAlloc(vhBufferMagazineThreadExit);
+		if (_vcore.magazineFls == FLS_OUT_OF_INDEXES)
+		{
+			vLogWarning(__func__, "Could not allocate magazine thread storage, "
+				"buffer will not use magazines.");
+			buffer->flags &= ~BUFFER_FLAG_MAGAZINE;
+		}
+		else
+		{
+			_vcore.magazineFlsReady = TRUE;
+		}
+	}
+
 	/* allocate memory for field and data */
 	buffer->useFieldLength  = (buffer->sizeBytes >> 0x03) + 1;
 	buffer->useField		= vAllocZeroed(sizeof(vUI64) * buffer->useFieldLength);
 	buffer->data			= vAllocZeroed(buffer->sizeBytes);
 
+	/* lock-free and magazine buffers need a seperate field */
+	/* for initialized elements								*/
+	if (buffer->flags & (BUFFER_FLAG_LOCKFREE | BUFFER_FLAG_MAGAZINE))
+		buffer->liveField = vAllocZeroed(sizeof(vUI64) * buffer->useFieldLength);
+
 	/* setup callbacks */
 	buffer->initializeFunc = initializeFunc;
 	buffer->destroyFunc    = destroyFunc;
@@ -114,8 +608,23 @@ VAPI vBOOL vDestroyBuffer(vHNDL buffHndl)
 	/* wait for buffer to finish */
 	vBufferLock(buffHndl);
 
-	/* destroy all elements */
-	for (int i = 0; i < buffer->capacity; i++)
+	/* return all cached slots and orphan every magazine. threads	*/
+	/* free orphaned magazines on their next lookup or on exit		*/
+	if (buffer->flags & BUFFER_FLAG_MAGAZINE)
+	{
+		vBufferFlushMagazines(buffHndl);
+		for (vPBufferMagazine mag = buffer->magazines; mag != NULL; mag = mag->nextInBuffer)
+		{
+			AcquireSRWLockExclusive(&mag->lock);
+			mag->owner = NULL;
+			ReleaseSRWLockExclusive(&mag->lock);
+		}
+		buffer->magazines = NULL;
+		buffer->flags &= ~BUFFER_FLAG_MAGAZINE;
+	}
+
+	/* destroy all elements, from the top so dense buffers never move */
+	for (int i = buffer->capacity - 1; i >= 0; i--)
 	{
 		vBufferRemoveIndex(buffHndl, i);
 	}
@@ -123,9 +632,10 @@ VAPI vBOOL vDestroyBuffer(vHNDL buffHndl)
 	/* free all memory */
 	vFree(buffer->data);
 	vFree(buffer->useField);
-	
-	/* delete buffer sync object */
-	DeleteCriticalSection(&buffer->rwPermission);
+	if (buffer->liveField) vFree(buffer->liveField);
+
+	/* release buffer sync object */
+	vBufferUnlock(buffHndl);
 	buffer->inUse = FALSE;
 
 	/* log buffer deletion */
@@ -141,116 +651,330 @@ VAPI vBOOL vDestroyBuffer(vHNDL buffHndl)
 /* ========== SYNCHRONIZATION					==========	*/
 VAPI void vBufferLock(vHNDL buffer)
 {
-	EnterCriticalSection(&_vcore.buffers[buffer].rwPermission);
+	vRWLockExclusive(&_vcore.buffers[buffer].rwPermission);
 }
 
 VAPI void vBufferUnlock(vHNDL buffer)
 {
-	LeaveCriticalSection(&_vcore.buffers[buffer].rwPermission);
+	vRWUnlockExclusive(&_vcore.buffers[buffer].rwPermission);
 }
 
+VAPI void vBufferLockShared(vHNDL buffer)
+{
+	vRWLockShared(&_vcore.buffers[buffer].rwPermission);
+}
 
-/* ========== ELEMENT MANIPULATION				==========	*/
-VAPI vPTR  vBufferAdd(vHNDL buffHndl, vPTR input)
+VAPI void vBufferUnlockShared(vHNDL buffer)
+{
+	vRWUnlockShared(&_vcore.buffers[buffer].rwPermission);
+}
+
+VAPI void vBufferFlushMagazines(vHNDL buffHndl)
 {
-	/* get buffer */
 	vPBuffer buff = vhGetBufferLocked(buffHndl);
+	if ((buff->flags & BUFFER_FLAG_MAGAZINE) == FALSE) return;
 
 	/* SYNC		*/ vBufferLock(buffHndl);
 
-	/* search for free index */
-	vUI16 startIndex = buff->elementsUsed >> 0x1;
-	for (vUI64 i = 0; i < buff->capacity; i++)
+	/* return every thread's cached slots to the shared field */
+	for (vPBufferMagazine mag = buff->magazines; mag != NULL; mag = mag->nextInBuffer)
 	{
-		/* start at offset */
-		vUI64 indexActual = (i + startIndex) % buff->capacity;
+		AcquireSRWLockExclusive(&mag->lock);
+		vhBufferMagazineDrain(buff, mag, 0);
+		ReleaseSRWLockExclusive(&mag->lock);
+	}
 
-		vUI64 chunk, bit = 0;
-		vhMapIndexToUseField(indexActual, &chunk, &bit);
+	/* UNSYNC	*/ vBufferUnlock(buffHndl);
+}
 
-		/* bittest to see if element is free */
-		BOOLEAN result = _bittest64(&buff->useField[chunk], bit);
-		if (result == TRUE) continue;
 
-		/* on element free, set bit and increment use count */
-		_bittestandset64(&buff->useField[chunk], bit);
-		buff->elementsUsed++;
+/* ========== ELEMENT MANIPULATION				==========	*/
+VAPI vPTR  vBufferAdd(vHNDL buffHndl, vPTR input)
+{
+	/* magazine and lock-free buffers never take the core lock */
+	vPBuffer buff = _vcore.buffers + buffHndl;
+	if (buff->flags & BUFFER_FLAG_MAGAZINE)
+		return vhBufferAddMagazine(buffHndl, buff, input);
+	if (buff->flags & BUFFER_FLAG_LOCKFREE)
+		return vhBufferAddLockFree(buffHndl, buff, input);
 
-		/* get ptr and zero memory */
-		vPTR elemPtr = buff->data + (indexActual * buff->elementSizeBytes);
-		vZeroMemory(elemPtr, buff->elementSizeBytes);
+	/* get buffer */
+	buff = vhGetBufferLocked(buffHndl);
 
-		/* call initialization callback if it exists */
-		if (buff->initializeFunc)
-			buff->initializeFunc(buffHndl, indexActual, elemPtr, input);
+	/* SYNC		*/ vBufferLock(buffHndl);
 
-		/* UNSYNC	*/ vBufferUnlock(buffHndl);
-		
-		return elemPtr;
+	/* search for free index. dense buffers always append */
+	vUI64 indexActual = ~0ULL;
+	if ((buff->flags & BUFFER_FLAG_DENSE) == FALSE)
+		indexActual = vhFindFreeBufferSlot(buff);
+	else if (buff->elementsUsed < buff->capacity)
+		indexActual = buff->elementsUsed;
+	if (indexActual == ~0ULL)
+	{
+		/* on reach here, buffer is full		*/
+		/* log and fatal err					*/
+		vLogWarning(__func__, "Buffer has no more free elements.");
+		vCoreFatalError(__func__, "Buffer has run out of free elements.");
 	}
 
-	/* on reach here, buffer is full		*/
-	/* log and fatal err					*/
-	vLogWarning(__func__, "Buffer has no more free elements.");
-	vCoreFatalError(__func__, "Buffer has run out of free elements.");
+	vUI64 chunk, bit = 0;
+	vhMapIndexToUseField(indexActual, &chunk, &bit);
+
+	/* on element free, set bit and increment use count */
+	_bittestandset64(&buff->useField[chunk], bit);
+	buff->elementsUsed++;
+
+	/* get ptr and zero memory */
+	vPTR elemPtr = buff->data + (indexActual * buff->elementSizeBytes);
+	vZeroMemory(elemPtr, buff->elementSizeBytes);
+
+	/* call initialization callback if it exists */
+	if (buff->initializeFunc)
+		buff->initializeFunc(buffHndl, indexActual, elemPtr, input);
+
+	/* UNSYNC	*/ vBufferUnlock(buffHndl);
+
+	return elemPtr;
 }
 
 VAPI void  vBufferRemove(vHNDL buffHndl, vPTR element)
 {
+	/* magazine and lock-free buffers never take the core lock */
+	vPBuffer buff = _vcore.buffers + buffHndl;
+	if (buff->flags & BUFFER_FLAG_MAGAZINE)
+	{
+		vhBufferRemoveMagazine(buffHndl, buff, vhMapPtrToBufferIndex(buff, element));
+		return;
+	}
+	if (buff->flags & BUFFER_FLAG_LOCKFREE)
+	{
+		vhBufferRemoveLockFree(buffHndl, buff, vhMapPtrToBufferIndex(buff, element));
+		return;
+	}
+
 	/* get buffer and element index */
-	vPBuffer buff = vhGetBufferLocked(buffHndl);
+	buff = vhGetBufferLocked(buffHndl);
 	vUI16 elementIndex = vhMapPtrToBufferIndex(buff, element);
 
 	/* SYNC		*/ vBufferLock(buffHndl);
 
-	/* check if spot is already removed */
-	vUI64 chunk, bit = 0;
-	vhMapIndexToUseField(elementIndex, &chunk, &bit);
-	if (_bittest64(&buff->useField[chunk], bit) == FALSE)
+	vhBufferRemoveLocked(buffHndl, buff, elementIndex);
+
+	/* UNSYNC	*/ vBufferUnlock(buffHndl);
+}
+
+VAPI void  vBufferRemoveIndex(vHNDL buffHndl, vUI16 index)
+{
+	/* magazine and lock-free buffers never take the core lock */
+	vPBuffer buff = _vcore.buffers + buffHndl;
+	if (buff->flags & BUFFER_FLAG_MAGAZINE)
 	{
-		vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+		vhBufferRemoveMagazine(buffHndl, buff, index);
+		return;
 	}
-	else
+	if (buff->flags & BUFFER_FLAG_LOCKFREE)
 	{
-		/* call destruction function (if exists) */
-		if (buff->destroyFunc)
-			buff->destroyFunc(buffHndl, elementIndex, element);
-
-		/* reset bit and decrement use count */
-		_bittestandreset64(&buff->useField[chunk], bit);
-		buff->elementsUsed--;
+		vhBufferRemoveLockFree(buffHndl, buff, index);
+		return;
 	}
 
+	/* get buffer and element index */
+	buff = vhGetBufferLocked(buffHndl);
+
+	/* SYNC		*/ vBufferLock(buffHndl);
+
+	vhBufferRemoveLocked(buffHndl, buff, index);
+
 	/* UNSYNC	*/ vBufferUnlock(buffHndl);
 }
 
-VAPI void  vBufferRemoveIndex(vHNDL buffHndl, vUI16 index)
+VAPI vUI32 vBufferAddBatch(vHNDL buffHndl, vUI32 count, vPTR* inputs, vPTR* elementsOut)
 {
-	/* get buffer and element index */
 	vPBuffer buff = vhGetBufferLocked(buffHndl);
 
-	/* SYNC		*/ vBufferLock(buffHndl);
+	/* lock-free and magazine buffers must claim atomically */
+	vBOOL atomic = (buff->flags & (BUFFER_FLAG_LOCKFREE | BUFFER_FLAG_MAGAZINE)) != 0;
+	vBOOL locked = (buff->flags & BUFFER_FLAG_LOCKFREE) == 0;
 
-	/* check if spot is already removed */
-	vUI64 chunk, bit = 0;
-	vhMapIndexToUseField(index, &chunk, &bit);
-	if (_bittest64(&buff->useField[chunk], bit) == FALSE)
+	/* SYNC		*/ if (locked) vBufferLock(buffHndl);
+
+	vUI32 added = 0;
+
+	/* dense buffers append one contiguous run */
+	if (buff->flags & BUFFER_FLAG_DENSE)
 	{
-		vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+		vUI64 first = buff->elementsUsed;
+		added = min(count, (vUI32)(buff->capacity - first));
+		vZeroMemory(buff->data + (first * buff->elementSizeBytes),
+			(vUI64)added * buff->elementSizeBytes);
+
+		for (vUI32 i = 0; i < added; i++)
+		{
+			vUI64 chunk, bit;
+			vhMapIndexToUseField(first + i, &chunk, &bit);
+			_bittestandset64(buff->useField + chunk, bit);
+
+			vPTR elemPtr = buff->data + ((first + i) * buff->elementSizeBytes);
+			if (buff->initializeFunc)
+				buff->initializeFunc(buffHndl, first + i, elemPtr,
+					inputs ? inputs[i] : NULL);
+			if (elementsOut) elementsOut[i] = elemPtr;
+		}
+
+		buff->elementsUsed += added;
 	}
-	else
+
+	while (added < count && (buff->flags & BUFFER_FLAG_DENSE) == FALSE)
+	{
+		/* claim as many free slots as possible from one word */
+		vUI64 chunk;
+		vUI64 claimMask = vhClaimFreeBufferRun(buff, count - added, &chunk, atomic);
+		if (claimMask == 0) break;
+
+		vhBufferZeroRuns(buff, chunk, claimMask);
+
+		/* initialize in index order */
+		vUI64 walk = claimMask;
+		while (walk != 0)
+		{
+			unsigned long bit;
+			_BitScanForward64(&bit, walk);
+			walk &= walk - 1;
+
+			vUI64 index = vhMapUseFieldToIndex(chunk, bit);
+			vPTR elemPtr = buff->data + (index * buff->elementSizeBytes);
+
+			if (buff->initializeFunc)
+				buff->initializeFunc(buffHndl, index, elemPtr,
+					inputs ? inputs[added] : NULL);
+			if (elementsOut) elementsOut[added] = elemPtr;
+			added++;
+		}
+
+		/* publish the whole run at once */
+		vUI16 claimCount = __popcnt64(claimMask);
+		if (atomic)
+		{
+			_InterlockedExchangeAdd16((volatile short*)&buff->elementsUsed, claimCount);
+			_InterlockedOr64((volatile vI64*)(buff->liveField + chunk), claimMask);
+		}
+		else
+		{
+			buff->elementsUsed += claimCount;
+		}
+	}
+
+	/* UNSYNC	*/ if (locked) vBufferUnlock(buffHndl);
+
+	if (added < count)
 	{
-		/* call destruction function (if exists) */
+		vLogWarningFormatted(__func__, "Buffer '%s' ran out of free elements, "
+			"added %d of %d.", buff->name, added, count);
+	}
+
+	return added;
+}
+
+static int vhCompareIndexDescending(const void* a, const void* b)
+{
+	return (int)*(const vUI16*)b - (int)*(const vUI16*)a;
+}
+
+VAPI vUI32 vBufferRemoveBatch(vHNDL buffHndl, vUI32 count, vPTR* elements)
+{
+	vPBuffer buff = vhGetBufferLocked(buffHndl);
+
+	/* dense buffers remove highest index first so that no	*/
+	/* pending element is moved by an earlier swap-remove	*/
+	if (buff->flags & BUFFER_FLAG_DENSE)
+	{
+		vPUI16 indices = vAlloc(max(1, count) * sizeof(vUI16));
+		for (vUI32 i = 0; i < count; i++)
+			indices[i] = vhMapPtrToBufferIndex(buff, elements[i]);
+		qsort(indices, count, sizeof(vUI16), vhCompareIndexDescending);
+
+		/* SYNC		*/ vBufferLock(buffHndl);
+
+		vUI32 removed = buff->elementsUsed;
+		for (vUI32 i = 0; i < count; i++)
+		{
+			if (i > 0 && indices[i] == indices[i - 1]) continue;
+			vhBufferRemoveLocked(buffHndl, buff, indices[i]);
+		}
+		removed -= buff->elementsUsed;
+
+		/* UNSYNC	*/ vBufferUnlock(buffHndl);
+
+		vFree(indices);
+		return removed;
+	}
+
+	vBOOL atomic = (buff->flags & (BUFFER_FLAG_LOCKFREE | BUFFER_FLAG_MAGAZINE)) != 0;
+	vBOOL locked = (buff->flags & BUFFER_FLAG_LOCKFREE) == 0;
+
+	/* SYNC		*/ if (locked) vBufferLock(buffHndl);
+
+	/* bits are released one word at a time */
+	vUI64 pendingChunk = ~0ULL;
+	vUI64 pendingMask  = 0;
+	vUI32 removed = 0;
+
+	for (vUI32 i = 0; i <= count; i++)
+	{
+		vUI64 chunk = ~0ULL, bit = 0;
+		vUI16 index = 0;
+		if (i < count)
+		{
+			index = vhMapPtrToBufferIndex(buff, elements[i]);
+			vhMapIndexToUseField(index, &chunk, &bit);
+		}
+
+		/* flush pending word on word change or at end */
+		if (chunk != pendingChunk && pendingMask != 0)
+		{
+			if (atomic)
+				_InterlockedAnd64((volatile vI64*)(buff->useField + pendingChunk), ~pendingMask);
+			else
+				buff->useField[pendingChunk] &= ~pendingMask;
+
+			buff->searchHint = pendingChunk;
+			pendingMask = 0;
+		}
+		if (i == count) break;
+		pendingChunk = chunk;
+
+		/* claim destruction of element */
+		vBOOL live;
+		if (atomic)
+		{
+			live = _interlockedbittestandreset64(buff->liveField + chunk, bit);
+		}
+		else
+		{
+			live = _bittest64(buff->useField + chunk, bit) &&
+				(pendingMask & (1ULL << bit)) == 0;
+		}
+		if (live == FALSE)
+		{
+			vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+			continue;
+		}
+
 		if (buff->destroyFunc)
-			buff->destroyFunc(buffHndl, index, 
-				(vPBYTE)buff->data + (index * buff->elementSizeBytes));
+			buff->destroyFunc(buffHndl, index, elements[i]);
 
-		/* reset bit and decrement use count */
-		_bittestandreset64(&buff->useField[chunk], bit);
-		buff->elementsUsed--;
+		pendingMask |= (1ULL << bit);
+		removed++;
 	}
 
-	/* UNSYNC	*/ vBufferUnlock(buffHndl);
+	if (atomic)
+		_InterlockedExchangeAdd16((volatile short*)&buff->elementsUsed, -(short)removed);
+	else
+		buff->elementsUsed -= removed;
+
+	/* UNSYNC	*/ if (locked) vBufferUnlock(buffHndl);
+
+	return removed;
 }
 
 VAPI vUI16 vBufferGetElementIndex(vHNDL buffer, vPTR element)
@@ -288,16 +1012,27 @@ VAPI void  vBufferIterate(vHNDL buffHndl, vPFBUFFERITERATEFUNC function, vPTR in
 
 	vPBuffer buff = vhGetBufferLocked(buffHndl);
 
-	/* SYNC		*/ vBufferLock(buffHndl);
+	/* SYNC		*/ vBufferLockShared(buffHndl);
+
+	/* dense buffers are a straight loop */
+	if (buff->flags & BUFFER_FLAG_DENSE)
+	{
+		for (vUI16 i = 0; i < buff->elementsUsed; i++)
+			function(buffHndl, i, buff->data + (i * buff->elementSizeBytes), input);
+
+		/* UNSYNC	*/ vBufferUnlockShared(buffHndl);
+		return;
+	}
 
 	/* loop over all ACTIVE elements	*/
+	vPUI64 liveField = vhBufferLiveField(buff);
 	vUI32 runCount = 0;
 	for (vUI16 i = 0; i < buff->capacity; i++)
 	{
 		vUI64 chunk, bit = 0;
 		vhMapIndexToUseField(i, &chunk, &bit);
 
-		if (_bittest64(&buff->useField[chunk], bit) == FALSE) continue;
+		if (_bittest64(&liveField[chunk], bit) == FALSE) continue;
 
 		function(buffHndl, i, buff->data + (i * buff->elementSizeBytes), input);
 		
@@ -305,7 +1040,157 @@ VAPI void  vBufferIterate(vHNDL buffHndl, vPFBUFFERITERATEFUNC function, vPTR in
 		if (runCount++ >= buff->elementsUsed)	break;
 	}
 
+	/* UNSYNC	*/ vBufferUnlockShared(buffHndl);
+}
+
+VAPI void  vBufferIterateParallel(vHNDL buffHndl, vPFBUFFERITERATEPARALLELFUNC function,
+	vPTR input, vPWorker* workers, vUI32 workerCount, vUI64 chunkDataSize,
+	vPFITERATEREDUCEFUNC reduceFunc)
+{
+	if (function == NULL)
+	{
+		vLogWarning(__func__, "Tried to iterate over buffer with NULL function.");
+		return;
+	}
+
+	vPBuffer buff = vhGetBufferLocked(buffHndl);
+
+	/* SYNC		*/ vBufferLockShared(buffHndl);
+
+	/* split elements (dense) or use field words into chunks */
+	vUI64 rangeSize = (buff->flags & BUFFER_FLAG_DENSE) ?
+		buff->elementsUsed : vhBufferFieldWordCount(buff);
+	if (workers == NULL) workerCount = 0;
+	vUI64 chunkCount = max(1, (vUI64)workerCount * WORKER_ITERATE_CHUNKS_PER_WORKER);
+	chunkCount = min(chunkCount, max(1, rangeSize));
+	vUI64 rangePerChunk = max(1, (rangeSize + chunkCount - 1) / chunkCount);
+	chunkCount = max(1, (rangeSize + rangePerChunk - 1) / rangePerChunk);
+
+	/* chunk descriptors, task inputs and zeroed chunk scratch */
+	vPBufferIterateChunk chunks = vAllocZeroed(sizeof(vBufferIterateChunk) * chunkCount);
+	vPTR* chunkInputs = vAllocZeroed(sizeof(vPTR) * chunkCount);
+	vPBYTE chunkData  = chunkDataSize ? vAllocZeroed(chunkDataSize * chunkCount) : NULL;
+
+	for (vUI64 i = 0; i < chunkCount; i++)
+	{
+		chunks[i].buffer	 = buffHndl;
+		chunks[i].function	 = function;
+		chunks[i].input		 = input;
+		chunks[i].chunkData	 = chunkData ? chunkData + (i * chunkDataSize) : NULL;
+		chunks[i].rangeStart = min(rangeSize, i * rangePerChunk);
+		chunks[i].rangeEnd	 = min(rangeSize, (i + 1) * rangePerChunk);
+		chunkInputs[i] = chunks + i;
+	}
+
+	/* run on workers, or inline when none were given. chunks	*/
+	/* left unclaimed by busy workers run on this thread		*/
+	if (workerCount == 0)
+	{
+		for (vUI64 i = 0; i < chunkCount; i++)
+			vhBufferIterateChunk(chunks + i);
+	}
+	else
+	{
+		vWorkerDispatchTaskGroup(workers, workerCount, vhBufferIterateChunkTask,
+			chunkInputs, chunkCount);
+	}
+
+	/* combine per-chunk results on the calling thread */
+	if (reduceFunc)
+	{
+		for (vUI64 i = 0; i < chunkCount; i++)
+			reduceFunc(chunks[i].chunkData, input);
+	}
+
+	vFree(chunks);
+	vFree(chunkInputs);
+	if (chunkData) vFree(chunkData);
+
+	/* UNSYNC	*/ vBufferUnlockShared(buffHndl);
+}
+
+VAPI void  vBufferSetRelocateFunc(vHNDL buffHndl, vPFBUFFERRELOCATEELEMENT relocateFunc)
+{
+	vPBuffer buff = vhGetBufferLocked(buffHndl);
+
+	/* SYNC		*/ vBufferLock(buffHndl);
+	buff->relocateFunc = relocateFunc;
+	/* UNSYNC	*/ vBufferUnlock(buffHndl);
+}
+
+VAPI vUI32 vBufferCompact(vHNDL buffHndl)
+{
+	vPBuffer buff = vhGetBufferLocked(buffHndl);
+
+	if (buff->flags & (BUFFER_FLAG_LOCKFREE | BUFFER_FLAG_MAGAZINE))
+	{
+		vLogWarning(__func__, "Cannot compact lock-free or magazine buffers.");
+		return 0;
+	}
+
+	/* SYNC		*/ vBufferLock(buffHndl);
+
+	vUI64 used		= buff->elementsUsed;
+	vUI64 usedChunk = used >> 0x06;
+	vUI64 usedBits	= used & 0b111111;
+	vUI64 wordCount = vhBufferFieldWordCount(buff);
+
+	/* pair each hole below elementsUsed with a live element above it */
+	vUI64 holeChunk  = 0;
+	vUI64 holeMask   = 0;
+	vUI64 liveChunk  = usedChunk;
+	vUI64 liveMask   = (liveChunk < wordCount) ? 
+		(buff->useField[liveChunk] & (~0ULL << usedBits)) : 0;
+	vUI32 movedCount = 0;
+
+	if (usedChunk > 0)	holeMask = ~buff->useField[0];
+	else				holeMask = ~buff->useField[0] & ((1ULL << usedBits) - 1);
+
+	while (used > 0)
+	{
+		/* advance to next hole */
+		while (holeMask == 0 && holeChunk < usedChunk)
+		{
+			holeChunk++;
+			holeMask = ~buff->useField[holeChunk];
+			if (holeChunk == usedChunk) holeMask &= (1ULL << usedBits) - 1;
+		}
+		if (holeMask == 0) break;
+
+		/* advance to next misplaced live element */
+		while (liveMask == 0 && liveChunk + 1 < wordCount)
+		{
+			liveChunk++;
+			liveMask = buff->useField[liveChunk];
+		}
+		if (liveMask == 0) break;
+
+		unsigned long holeBit, liveBit;
+		_BitScanForward64(&holeBit, holeMask);
+		_BitScanForward64(&liveBit, liveMask);
+		holeMask &= holeMask - 1;
+		liveMask &= liveMask - 1;
+
+		vhBufferMoveElement(buffHndl, buff, vhMapUseFieldToIndex(liveChunk, liveBit),
+			vhMapUseFieldToIndex(holeChunk, holeBit));
+		movedCount++;
+	}
+
+	/* rewrite field so exactly the first elementsUsed bits are set */
+	for (vUI64 chunk = 0; chunk < wordCount; chunk++)
+	{
+		if (chunk < usedChunk)			buff->useField[chunk] = ~0ULL;
+		else if (chunk == usedChunk)	buff->useField[chunk] = (1ULL << usedBits) - 1;
+		else							buff->useField[chunk] = 0;
+	}
+	buff->searchHint = usedChunk;
+
 	/* UNSYNC	*/ vBufferUnlock(buffHndl);
+
+	vLogInfoFormatted(__func__, "Compacted buffer '%s', moved %d elements.",
+		buff->name, movedCount);
+
+	return movedCount;
 }
 
 VAPI vPTR  vBufferGetData(vHNDL buffer, PSIZE_T dataSize)
@@ -356,6 +1241,6 @@ VAPI vBOOL vBufferIndexUsed(vHNDL buffer, vUI16 index)
 	vPBuffer buff = vhGetBufferLocked(buffer);
 	vUI64 chunk, bit;
 	vhMapIndexToUseField(index, &chunk, &bit);
-	return _bittest64(&buff->useField[chunk], bit);
+	return _bittest64(&vhBufferLiveField(buff)[chunk], bit);
 }
 
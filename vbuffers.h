@@ -14,21 +14,37 @@
 VAPI vHNDL vCreateBuffer(const char* bufferName, vUI16 elementSize,
 	vUI16 capacity, vPFBUFFERINITIALIZEELEMENT initializeFunc,
 	vPFBUFFERDESTROYELEMENT destroyFunc);
+VAPI vHNDL vCreateBufferEx(const char* bufferName, vUI16 elementSize,
+	vUI16 capacity, vPFBUFFERINITIALIZEELEMENT initializeFunc,
+	vPFBUFFERDESTROYELEMENT destroyFunc, vBYTE flags);
 VAPI vBOOL vDestroyBuffer(vHNDL buffer);
 
 
 /* ========== SYNCHRONIZATION					==========	*/
 VAPI void vBufferLock(vHNDL buffer);
 VAPI void vBufferUnlock(vHNDL buffer);
+VAPI void vBufferLockShared(vHNDL buffer);
+VAPI void vBufferUnlockShared(vHNDL buffer);
+VAPI void vBufferFlushMagazines(vHNDL buffer);
 
 
 /* ========== ELEMENT MANIPULATION				==========	*/
 VAPI vPTR  vBufferAdd(vHNDL buffer, vPTR input);
 VAPI void  vBufferRemove(vHNDL buffer, vPTR element);
 VAPI void  vBufferRemoveIndex(vHNDL buffer, vUI16 index);
+VAPI vUI32 vBufferAddBatch(vHNDL buffer, vUI32 count, vPTR* inputs, vPTR* elementsOut);
+VAPI vUI32 vBufferRemoveBatch(vHNDL buffer, vUI32 count, vPTR* elements);
 VAPI vUI16 vBufferGetElementIndex(vHNDL buffer, vPTR element);
 VAPI vPTR  vBufferGetIndex(vHNDL buffer, vUI16 index);
+/* iterate callbacks run under the shared lock. unless the	*/
+/* buffer is lock-free they must not add, remove or compact	*/
+/* on the buffer being iterated, that is a fatal error		*/
 VAPI void  vBufferIterate(vHNDL buffer, vPFBUFFERITERATEFUNC function, vPTR input);
+VAPI void  vBufferIterateParallel(vHNDL buffer, vPFBUFFERITERATEPARALLELFUNC function,
+	vPTR input, vPWorker* workers, vUI32 workerCount, vUI64 chunkDataSize,
+	vPFITERATEREDUCEFUNC reduceFunc);
+VAPI void  vBufferSetRelocateFunc(vHNDL buffer, vPFBUFFERRELOCATEELEMENT relocateFunc);
+VAPI vUI32 vBufferCompact(vHNDL buffer);
 VAPI vPTR  vBufferGetData(vHNDL buffer, PSIZE_T dataSize);
 VAPI vUI64 vBufferGetField(vHNDL buffer, PSIZE_T fieldSize);
 
@@ -0,0 +1,318 @@
+
+/* ========== <vcommands.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vcommands.h"
+#include <stdlib.h>
+
+
+/* ========== HELPER							==========	*/
+static __forceinline vUI32 vhCommandWorkerIndex(vPWorker worker)
+{
+	return (vUI32)(worker - _vcore.workers);
+}
+
+static __forceinline vEHNDL vhCommandPendingHandle(vPWorker worker, vUI32 epoch,
+	vUI32 index)
+{
+	/* generation field holds batch epoch and worker, never zero */
+	vUI64 tag = ((epoch & 0xFF) << 0x08) | (vhCommandWorkerIndex(worker) + 1);
+	return (tag << DBUFFER_HANDLE_GENERATION_SHIFT) |
+		(COMMAND_PENDING_NODE << DBUFFER_HANDLE_NODE_SHIFT) | index;
+}
+
+static __forceinline vBOOL vhCommandPendingMatches(vEHNDL handle, vPWorker worker,
+	vUI32 epoch)
+{
+	vUI64 tag = handle >> DBUFFER_HANDLE_GENERATION_SHIFT;
+	return (tag & 0xFF) == (vhCommandWorkerIndex(worker) + 1) &&
+		(tag >> 0x08) == (epoch & 0xFF);
+}
+
+static void vhCommandPush(vPWorker worker, vBYTE type, vEHNDL object, vEHNDL parent,
+	vUI16 component, vPTR input)
+{
+	if (worker->commandCount == worker->commandCapacity)
+	{
+		vUI32 newCapacity = max(COMMAND_INITIAL_CAPACITY, worker->commandCapacity << 1);
+		vPCommand newCommands = vAllocZeroed(sizeof(vCommand) * newCapacity);
+		if (worker->commands)
+		{
+			vMemCopy(newCommands, worker->commands, sizeof(vCommand) * worker->commandCount);
+			vFree(worker->commands);
+		}
+		worker->commands		= newCommands;
+		worker->commandCapacity = newCapacity;
+	}
+
+	vPCommand command = worker->commands + worker->commandCount;
+	command->type	   = type;
+	command->component = component;
+	command->sequence  = worker->commandCount;
+	command->object	   = object;
+	command->parent	   = parent;
+	command->input	   = input;
+	worker->commandCount++;
+}
+
+static vPObject vhCommandResolveInBatch(vPCommandBatch batch, vEHNDL handle)
+{
+	if (vCommandIsPending(handle) == FALSE) return vObjectResolve(handle);
+
+	/* pending handles only resolve within their own batch */
+	vUI32 index = (vUI32)(handle & DBUFFER_HANDLE_FIELD_MASK);
+	if (vhCommandPendingMatches(handle, batch->worker, batch->epoch) == FALSE ||
+		index >= batch->createdCount) return NULL;
+	return vObjectResolve(batch->created[index]);
+}
+
+static int vhCommandRefCompare(const void* left, const void* right)
+{
+	const vCommandRef* a = left;
+	const vCommandRef* b = right;
+
+	/* group by component, keep recording order within a group */
+	if (a->command->component != b->command->component)
+		return (a->command->component < b->command->component) ? -1 : 1;
+	if (a->batch != b->batch)
+		return (a->batch < b->batch) ? -1 : 1;
+	return (a->command->sequence < b->command->sequence) ? -1 :
+		(a->command->sequence > b->command->sequence);
+}
+
+static vUI32 vhCommandApplyComponents(vPCommandRef refs, vUI32 refCount, vPUI32 staleOut,
+	vPUI32 failedOut)
+{
+	vUI32 applied = 0;
+	qsort(refs, refCount, sizeof(vCommandRef), vhCommandRefCompare);
+
+	/* each change takes the same locks as a direct call, in	*/
+	/* the same order. grouping by type keeps containers warm	*/
+	for (vUI32 i = 0; i < refCount; i++)
+	{
+		vPCommand command = refs[i].command;
+		vPObject object = vhCommandResolveInBatch(refs[i].batch, command->object);
+		if (object == NULL)
+		{
+			(*staleOut)++;
+			continue;
+		}
+
+		vBOOL result = (command->type == COMMAND_ADD_COMPONENT) ?
+			(vObjectAddComponent(object, command->component, command->input) != NULL) :
+			vObjectRemoveComponent(object, command->component);
+		if (result)	applied++;
+		else		(*failedOut)++;
+	}
+
+	return applied;
+}
+
+
+/* ========== RECORDING							==========	*/
+VAPI vEHNDL vCommandCreateObject(vPWorker worker, vEHNDL parent)
+{
+	vWorkerLock(worker); /* SYNC */
+
+	vEHNDL pending = vhCommandPendingHandle(worker, worker->commandEpoch,
+		worker->pendingCount++);
+	vhCommandPush(worker, COMMAND_CREATE_OBJECT, pending, parent, 0, NULL);
+
+	vWorkerUnlock(worker); /* UNSYNC */
+	return pending;
+}
+
+VAPI void   vCommandDestroyObject(vPWorker worker, vEHNDL object)
+{
+	vWorkerLock(worker);
+	vhCommandPush(worker, COMMAND_DESTROY_OBJECT, object, DBUFFER_HANDLE_INVALID, 0, NULL);
+	vWorkerUnlock(worker);
+}
+
+VAPI void   vCommandAddComponent(vPWorker worker, vEHNDL object, vUI16 component,
+	vPTR input)
+{
+	vWorkerLock(worker);
+	vhCommandPush(worker, COMMAND_ADD_COMPONENT, object, DBUFFER_HANDLE_INVALID,
+		component, input);
+	vWorkerUnlock(worker);
+}
+
+VAPI void   vCommandRemoveComponent(vPWorker worker, vEHNDL object, vUI16 component)
+{
+	vWorkerLock(worker);
+	vhCommandPush(worker, COMMAND_REMOVE_COMPONENT, object, DBUFFER_HANDLE_INVALID,
+		component, NULL);
+	vWorkerUnlock(worker);
+}
+
+VAPI vUI32  vCommandGetCount(vPWorker worker)
+{
+	vWorkerLock(worker);
+	vUI32 count = worker->commandCount;
+	vWorkerUnlock(worker);
+	return count;
+}
+
+
+/* ========== APPLICATION						==========	*/
+VAPI vUI32 vCommandApply(vPWorker* workers, vUI32 workerCount)
+{
+	if (workers == NULL || workerCount == 0) return 0;
+
+	/* applying waits for the running frame to end */
+	if (vSchedulerInSystem())
+	{
+		vLogError(__func__, "Tried to apply commands inside a scheduler system.");
+		return 0;
+	}
+
+	/* take each worker's batch, recording continues into a new one */
+	vPCommandBatch batches = vAllocZeroed(sizeof(vCommandBatch) * workerCount);
+	vUI32 commandCount = 0;
+	for (vUI32 i = 0; i < workerCount; i++)
+	{
+		vPWorker	   worker = workers[i];
+		vPCommandBatch batch  = batches + i;
+		vWorkerLock(worker);
+
+		batch->worker		= worker;
+		batch->epoch		= worker->commandEpoch++;
+		batch->commands		= worker->commands;
+		batch->commandCount = worker->commandCount;
+		batch->createdCount = worker->pendingCount;
+		batch->created		= vAllocZeroed(sizeof(vEHNDL) * max(1, worker->pendingCount));
+
+		worker->commands		= NULL;
+		worker->commandCount	= 0;
+		worker->commandCapacity = 0;
+		worker->pendingCount	= 0;
+
+		vWorkerUnlock(worker);
+		commandCount += batch->commandCount;
+	}
+
+	vUI32 applied = 0;
+	vUI32 stale   = 0;
+	vUI32 failed  = 0;
+	if (commandCount > 0)
+	{
+		/* release and object buffer locks are taken once for all,	*/
+		/* in the order vDestroyObject takes them. everything else	*/
+		/* is per change											*/
+		vRWLockExclusive(&_vcore.objectReleaseLock);
+		vObjectGlobalLock(); /* SYNC */
+
+		/* creations first, in order, so pending parents exist */
+		vPCommandRef refs = vAllocZeroed(sizeof(vCommandRef) * commandCount);
+		vUI32 refCount = 0;
+		for (vUI32 i = 0; i < workerCount; i++)
+		{
+			vPCommandBatch batch = batches + i;
+			for (vUI32 j = 0; j < batch->commandCount; j++)
+			{
+				vPCommand command = batch->commands + j;
+				if (command->type == COMMAND_CREATE_OBJECT)
+				{
+					vPObject object = vCreateObject(
+						vhCommandResolveInBatch(batch, command->parent));
+					batch->created[command->object & DBUFFER_HANDLE_FIELD_MASK] =
+						vObjectGetHandle(object);
+					applied++;
+				}
+				else if (command->type != COMMAND_DESTROY_OBJECT)
+				{
+					refs[refCount].batch   = batch;
+					refs[refCount].command = command;
+					refCount++;
+				}
+			}
+		}
+
+		/* component changes, grouped by component type */
+		applied += vhCommandApplyComponents(refs, refCount, &stale, &failed);
+		vFree(refs);
+
+		/* destructions last, so earlier commands still resolve */
+		for (vUI32 i = 0; i < workerCount; i++)
+		{
+			vPCommandBatch batch = batches + i;
+			for (vUI32 j = 0; j < batch->commandCount; j++)
+			{
+				vPCommand command = batch->commands + j;
+				if (command->type != COMMAND_DESTROY_OBJECT) continue;
+
+				vPObject object = vhCommandResolveInBatch(batch, command->object);
+				if (object == NULL)
+				{
+					stale++;
+					continue;
+				}
+				vDestroyObject(object);
+				applied++;
+			}
+		}
+
+		vObjectGlobalUnlock(); /* UNSYNC */
+		vRWUnlockExclusive(&_vcore.objectReleaseLock);
+
+		if (stale > 0)
+		{
+			vLogWarningFormatted(__func__, "Skipped %d of %d commands on stale handles.",
+				stale, commandCount);
+		}
+		if (failed > 0)
+		{
+			vLogWarningFormatted(__func__, "%d of %d component commands could not be "
+				"applied, the component was already present or missing.", failed,
+				commandCount);
+		}
+	}
+
+	/* publish live handles of created objects */
+	for (vUI32 i = 0; i < workerCount; i++)
+	{
+		vPCommandBatch batch  = batches + i;
+		vPWorker	   worker = batch->worker;
+		vWorkerLock(worker);
+
+		if (worker->appliedCreated) vFree(worker->appliedCreated);
+		worker->appliedEpoch		= batch->epoch;
+		worker->appliedCreated		= batch->created;
+		worker->appliedCreatedCount = batch->createdCount;
+
+		vWorkerUnlock(worker);
+		if (batch->commands) vFree(batch->commands);
+	}
+
+	vFree(batches);
+	return applied;
+}
+
+
+/* ========== HANDLES							==========	*/
+VAPI vBOOL    vCommandIsPending(vEHNDL handle)
+{
+	return ((handle >> DBUFFER_HANDLE_NODE_SHIFT) & DBUFFER_HANDLE_FIELD_MASK) ==
+		COMMAND_PENDING_NODE;
+}
+
+VAPI vPObject vCommandResolve(vPWorker worker, vEHNDL handle)
+{
+	if (vCommandIsPending(handle) == FALSE) return vObjectResolve(handle);
+
+	/* pending handles resolve once their batch was applied */
+	vPObject object = NULL;
+	vUI32	 index	= (vUI32)(handle & DBUFFER_HANDLE_FIELD_MASK);
+	vWorkerLock(worker);
+
+	if (worker->appliedCreated != NULL &&
+		vhCommandPendingMatches(handle, worker, worker->appliedEpoch) &&
+		index < worker->appliedCreatedCount)
+		object = vObjectResolve(worker->appliedCreated[index]);
+
+	vWorkerUnlock(worker);
+	return object;
+}
@@ -0,0 +1,40 @@
+
+/* ========== <vcommands.h>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Deferred structural changes recorded per worker			*/
+
+#ifndef _VCORE_COMMANDS_INCLUDE_
+#define _VCORE_COMMANDS_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+
+
+/* ========== USAGE								==========	*/
+/* component cycles and tasks record object changes into	*/
+/* their worker's buffer instead of taking object locks.	*/
+/* objects created by a command get a pending handle, which	*/
+/* later commands of the same worker may refer to. call		*/
+/* vCommandApply at a sync point where no other thread is	*/
+/* making direct structural changes. inputs passed to add	*/
+/* component must stay valid until then						*/
+
+
+/* ========== RECORDING							==========	*/
+VAPI vEHNDL vCommandCreateObject(vPWorker worker, vEHNDL parent);
+VAPI void   vCommandDestroyObject(vPWorker worker, vEHNDL object);
+VAPI void   vCommandAddComponent(vPWorker worker, vEHNDL object, vUI16 component,
+	vPTR input);
+VAPI void   vCommandRemoveComponent(vPWorker worker, vEHNDL object, vUI16 component);
+VAPI vUI32  vCommandGetCount(vPWorker worker);
+
+
+/* ========== APPLICATION						==========	*/
+VAPI vUI32 vCommandApply(vPWorker* workers, vUI32 workerCount);
+
+
+/* ========== HANDLES							==========	*/
+VAPI vBOOL    vCommandIsPending(vEHNDL handle);
+VAPI vPObject vCommandResolve(vPWorker worker, vEHNDL handle);
+
+#endif
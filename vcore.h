@@ -17,8 +17,16 @@
 #include "vfileio.h"			/* file manipulation functions	*/
 #include "vlock.h"				/* thread synchronization		*/
 #include "vdbuffers.h"			/* dynamic buffering system		*/
+#include "vlbuffers.h"			/* large buffering system		*/
 #include "vobject.h"			/* object/component system		*/
+#include "vtransform.h"			/* vectorized transform math	*/
+#include "vhierarchy.h"			/* object trees and world space	*/
+#include "varchetype.h"			/* archetype object storage		*/
+#include "vprefab.h"			/* bulk object instantiation	*/
+#include "vquery.h"				/* cached component queries		*/
 #include "vworker.h"			/* flexible threading system	*/
+#include "vscheduler.h"			/* parallel system scheduler	*/
+#include "vcommands.h"			/* deferred structural changes	*/
 
 
 #endif
@@ -81,10 +81,28 @@ VAPI vBOOL vCoreInitialize(void)
 		*(DWORD*)&_vcore.locks[i] = UNUSED_LOCK;
 	}
 
+	/* initialize core reader/writer locks */
+	vRWLockInitialize(&_vcore.archetypeLock);
+	vRWLockInitialize(&_vcore.queryLock);
+	vRWLockInitialize(&_vcore.systemLock);
+	vRWLockInitialize(&_vcore.hierarchyLock);
+	vRWLockInitialize(&_vcore.objectReleaseLock);
+
+	/* marks threads that are running a scheduler system */
+	_vcore.systemFls = FlsAlloc(NULL);
+	if (_vcore.systemFls == FLS_OUT_OF_INDEXES)
+	{
+		vLogError(__func__, "Could not allocate scheduler thread storage.");
+		vCoreFatalError(__func__, "Could not allocate scheduler thread storage.");
+	}
+
 	/* create object buffer */
 	_vcore.objects = vCreateDBuffer("VCore Object Dynamic Buffer",
 		sizeof(vObject), VOBJECT_NODE_SIZE, NULL, NULL);
 
+	/* pick widest transform kernels the cpu supports */
+	vTransformSetSIMDLevel(TRANSFORM_SIMD_BEST);
+
 	/* log startup */
 	vLogInfo(__func__, "VCore initialized.");
 
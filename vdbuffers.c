@@ -25,22 +25,197 @@ static __forceinline vUI32 vhFindFreeDBufferIndex(void)
 	vCoreFatalError(__func__, "Could not create more dynamic buffers.");
 }
 
+static __forceinline vPDBufferNodeEntry vhGetNodeEntry(vPDBuffer buffer, vUI64 nodeIndex)
+{
+	/* table and pages are published with interlocked writes so	*/
+	/* handle resolution can walk them without the buffer lock	*/
+	vPDBufferNodeEntry* table = ReadPointerAcquire((PVOID const volatile*)&buffer->nodeTable);
+	if (table == NULL) return NULL;
+	if (nodeIndex >= DBUFFER_NODE_TABLE_PAGE_SIZE * DBUFFER_NODE_TABLE_PAGES) return NULL;
+
+	vPDBufferNodeEntry page = ReadPointerAcquire((PVOID const volatile*)
+		(table + (nodeIndex / DBUFFER_NODE_TABLE_PAGE_SIZE)));
+	if (page == NULL) return NULL;
+	return page + (nodeIndex % DBUFFER_NODE_TABLE_PAGE_SIZE);
+}
+
+static __forceinline vUI64 vhNodeBlockOffset(vPDBuffer buffer)
+{
+	/* node header, then the use field, then the element block */
+	return sizeof(vDBufferNode) + ((((vUI64)buffer->nodeSize >> 0x06) + 1) * sizeof(vUI64));
+}
+
+static __forceinline vUI32 vhNodeAddressSlot(vPDBuffer buffer, vPDBufferNode node)
+{
+	/* node bases are aligned, hash the bits above the alignment */
+	vUI64 key = (vUI64)node / buffer->nodeAlignment;
+	return (vUI32)((key * 0x9E3779B97F4A7C15ULL) >> 0x20) &
+		(buffer->nodeAddressCapacity - 1);
+}
+
+static __forceinline vBOOL vhNodeAddressContains(vPDBuffer buffer, vPDBufferNode node)
+{
+	if (buffer->nodeAddresses == NULL) return FALSE;
+
+	vUI32 mask = buffer->nodeAddressCapacity - 1;
+	for (vUI32 slot = vhNodeAddressSlot(buffer, node);
+		buffer->nodeAddresses[slot] != NULL; slot = (slot + 1) & mask)
+	{
+		if (buffer->nodeAddresses[slot] == node) return TRUE;
+	}
+	return FALSE;
+}
+
+static void vhNodeAddressInsert(vPDBuffer buffer, vPDBufferNode node)
+{
+	/* keep the set at most half full so probes stay short */
+	if ((buffer->nodeAddressCount + 1) * 2 > buffer->nodeAddressCapacity)
+	{
+		vPDBufferNode* oldAddresses = buffer->nodeAddresses;
+		vUI32 oldCapacity = buffer->nodeAddressCapacity;
+
+		buffer->nodeAddressCapacity = (oldCapacity == 0) ?
+			DBUFFER_NODE_ADDRESS_MIN : oldCapacity * 2;
+		buffer->nodeAddresses = vAllocZeroed(sizeof(vPDBufferNode) *
+			buffer->nodeAddressCapacity);
+		buffer->nodeAddressCount = 0;
+
+		for (vUI32 i = 0; i < oldCapacity; i++)
+		{
+			if (oldAddresses[i] == NULL) continue;
+			vhNodeAddressInsert(buffer, oldAddresses[i]);
+		}
+		if (oldAddresses) vFree(oldAddresses);
+	}
+
+	vUI32 mask = buffer->nodeAddressCapacity - 1;
+	vUI32 slot = vhNodeAddressSlot(buffer, node);
+	while (buffer->nodeAddresses[slot] != NULL) slot = (slot + 1) & mask;
+	buffer->nodeAddresses[slot] = node;
+	buffer->nodeAddressCount++;
+}
+
+static __forceinline void vhNodeAddressRemove(vPDBuffer buffer, vPDBufferNode node)
+{
+	vUI32 mask = buffer->nodeAddressCapacity - 1;
+	vUI32 slot = vhNodeAddressSlot(buffer, node);
+	while (buffer->nodeAddresses[slot] != node)
+	{
+		if (buffer->nodeAddresses[slot] == NULL) return;
+		slot = (slot + 1) & mask;
+	}
+
+	/* shift later entries of the probe run back into the gap */
+	vUI32 gap = slot;
+	for (slot = (gap + 1) & mask; buffer->nodeAddresses[slot] != NULL;
+		slot = (slot + 1) & mask)
+	{
+		vUI32 home = vhNodeAddressSlot(buffer, buffer->nodeAddresses[slot]);
+		if (((slot - home) & mask) < ((slot - gap) & mask)) continue;
+
+		buffer->nodeAddresses[gap] = buffer->nodeAddresses[slot];
+		gap = slot;
+	}
+	buffer->nodeAddresses[gap] = NULL;
+	buffer->nodeAddressCount--;
+}
+
+static __forceinline void vhRegisterBufferNode(vPDBuffer buffer, vPDBufferNode node)
+{
+	if (buffer->nodeTable == NULL)
+		InterlockedExchangePointer((PVOID volatile*)&buffer->nodeTable,
+			vAllocZeroed(sizeof(vPDBufferNodeEntry) * DBUFFER_NODE_TABLE_PAGES));
+
+	/* reuse the lowest free index, otherwise take a new one */
+	vUI32 nodeIndex = 0;
+	while (nodeIndex < buffer->nodeTableUsed &&
+		vhGetNodeEntry(buffer, nodeIndex)->node != NULL) nodeIndex++;
+	if (nodeIndex == buffer->nodeTableUsed)
+	{
+		if (nodeIndex >= DBUFFER_NODE_TABLE_PAGE_SIZE * DBUFFER_NODE_TABLE_PAGES)
+		{
+			vLogError(__func__, "Dynamic buffer node table is full.");
+			vCoreFatalError(__func__, "Dynamic buffer node table is full.");
+		}
+
+		vPDBufferNodeEntry* page = buffer->nodeTable + (nodeIndex / DBUFFER_NODE_TABLE_PAGE_SIZE);
+		if (*page == NULL)
+			InterlockedExchangePointer((PVOID volatile*)page,
+				vAllocZeroed(sizeof(vDBufferNodeEntry) * DBUFFER_NODE_TABLE_PAGE_SIZE));
+		buffer->nodeTableUsed++;
+	}
+
+	/* generations are kept across node reuse */
+	vPDBufferNodeEntry entry = vhGetNodeEntry(buffer, nodeIndex);
+	if (entry->generations == NULL)
+		entry->generations = vAllocZeroed(sizeof(vUI16) * buffer->nodeSize);
+
+	node->nodeIndex	  = nodeIndex;
+	node->generations = entry->generations;
+	InterlockedExchangePointer((PVOID volatile*)&entry->node, node);
+}
+
+static __forceinline void vhBumpSlotGeneration(vPDBufferNode node, vUI64 slot)
+{
+	/* bumped on add and on remove, so a handle's generation only	*/
+	/* matches while the element it was taken from is still live.	*/
+	/* zero is never a valid generation							*/
+	vUI16 generation = node->generations[slot] + 1;
+	if (generation == 0) generation = 1;
+	*(volatile vUI16*)(node->generations + slot) = generation;
+}
+
 static __forceinline vPDBufferNode vhCreateBufferNode(vPDBuffer parent)
 {
-	EnterCriticalSection(&parent->rwPermission);
+	vRWLockExclusive(&parent->rwPermission);
+
+	vPBYTE reservation = NULL;
+	vPBYTE alignedBase = NULL;
+	if (parent->arenaBase != NULL)
+	{
+		/* arena nodes are committed right after the last one */
+		if (parent->arenaNodesCommitted >= parent->arenaMaxNodes)
+		{
+			vLogErrorFormatted(__func__, "Dynamic buffer '%s' arena is full.",
+				parent->name);
+			vCoreFatalError(__func__, "Dynamic buffer arena is full.");
+		}
+
+		reservation = parent->arenaReservation;
+		alignedBase = parent->arenaBase +
+			((vUI64)parent->arenaNodesCommitted * parent->nodeAlignment);
+		parent->arenaNodesCommitted++;
+	}
+	else
+	{
+		/* reservations already start on an allocation granule,	*/
+		/* only larger alignments need slack to place the node.	*/
+		/* unused slack stays reserved but is never committed		*/
+		vUI64 reserveSize = parent->nodeCommitBytes;
+		if (parent->nodeAlignment > parent->nodeGranularity)
+			reserveSize += parent->nodeAlignment;
+		reservation = VirtualAlloc(NULL, reserveSize, MEM_RESERVE, PAGE_NOACCESS);
+		alignedBase = (vPBYTE)(((vUI64)reservation + parent->nodeAlignment - 1) &
+			~(parent->nodeAlignment - 1));
+	}
 
-	vUI64 nodeSize = sizeof(vDBufferNode);
-	vUI64 useFieldSize = (((vUI64)parent->nodeSize >> 0x06) + 1) * sizeof(vUI64);
-	vUI64 blockSize = parent->nodeSize * parent->elementSizeBytes;
+	/* commit node memory, which is zeroed by the system */
+	vPDBufferNode node = NULL;
+	if (reservation != NULL)
+		node = VirtualAlloc(alignedBase, parent->nodeCommitBytes, MEM_COMMIT, PAGE_READWRITE);
+	if (node == NULL) vCoreFatalError(__func__,
+		"Could not allocate more memory.");
+	_vcore.memoryUseage += parent->nodeCommitBytes;
 
-	/* alloc node to heap */
-	vPDBufferNode node = vAllocZeroed(nodeSize + useFieldSize + blockSize);
+	node->parent	  = parent;
+	node->reservation = (parent->arenaBase != NULL) ? NULL : reservation;
+	node->useField = (vPBYTE)(node) + sizeof(vDBufferNode);
+	node->block =    (vPBYTE)(node) + vhNodeBlockOffset(parent);
 
-	node->parent   = parent;
-	node->useField = (vPBYTE)(node) + nodeSize;
-	node->block =    (vPBYTE)(node->useField) + useFieldSize;
+	vhRegisterBufferNode(parent, node);
+	if (parent->arenaBase == NULL) vhNodeAddressInsert(parent, node);
 
-	LeaveCriticalSection(&parent->rwPermission);
+	vRWUnlockExclusive(&parent->rwPermission);
 
 	return node;
 }
@@ -48,11 +223,26 @@ static __forceinline vPDBufferNode vhCreateBufferNode(vPDBuffer parent)
 static __forceinline void vhDestroyBufferNode(vPDBufferNode node)
 {
 	vPDBuffer parent = node->parent;
-	EnterCriticalSection(&parent->rwPermission);
+	vRWLockExclusive(&parent->rwPermission);
 
-	vFree(node);
+	/* unpublish before the memory goes away */
+	InterlockedExchangePointer((PVOID volatile*)
+		&vhGetNodeEntry(parent, node->nodeIndex)->node, NULL);
+	_vcore.memoryUseage -= parent->nodeCommitBytes;
 
-	LeaveCriticalSection(&parent->rwPermission);
+	/* arena nodes only give their pages back */
+	if (node->reservation == NULL)
+	{
+		VirtualFree(node, parent->nodeCommitBytes, MEM_DECOMMIT);
+		parent->arenaNodesCommitted--;
+	}
+	else
+	{
+		vhNodeAddressRemove(parent, node);
+		VirtualFree(node->reservation, 0, MEM_RELEASE);
+	}
+
+	vRWUnlockExclusive(&parent->rwPermission);
 }
 
 static __forceinline void vhMapIndexToUseField(vUI64 index, vPUI64 chunk, vPUI64 bit)
@@ -66,30 +256,280 @@ static __forceinline vUI64 vhMapUseFieldToIndex(vUI64 chunk, vUI64 bit)
 	return (chunk << 0x06) + bit;
 }
 
-static __forceinline vUI32 vhFindFreeBufferNodeIndex(vPDBufferNode node)
+static __forceinline void vhFreeListPush(vPDBuffer buffer, vPDBufferNode node)
+{
+	if (node->inFreeList) return;
+
+	node->prevFree = NULL;
+	node->nextFree = buffer->freeHead;
+	if (buffer->freeHead) buffer->freeHead->prevFree = node;
+	buffer->freeHead = node;
+	node->inFreeList = TRUE;
+}
+
+static __forceinline void vhFreeListUnlink(vPDBuffer buffer, vPDBufferNode node)
 {
-	/* if node is full, return */
-	if (node->elementCount >= node->parent->nodeSize) return ~0;
+	if (node->inFreeList == FALSE) return;
 
-	/* find unused */
-	for (vUI64 i = 0; i < node->parent->nodeSize; i++)
+	if (node->prevFree) node->prevFree->nextFree = node->nextFree;
+	else				buffer->freeHead		 = node->nextFree;
+	if (node->nextFree) node->nextFree->prevFree = node->prevFree;
+
+	node->nextFree = NULL;
+	node->prevFree = NULL;
+	node->inFreeList = FALSE;
+}
+
+static __forceinline vPDBufferNode vhAppendBufferNode(vPDBuffer buffer)
+{
+	vPDBufferNode node = vhCreateBufferNode(buffer);
+
+	/* link at tail */
+	if (buffer->head == NULL)	buffer->head	   = node;
+	else						buffer->tail->next = node;
+	buffer->tail = node;
+
+	/* new node is empty */
+	vhFreeListPush(buffer, node);
+	buffer->nodeCount++;
+	buffer->emptyNodeCount++;
+
+	return node;
+}
+
+static __forceinline vPDBufferNode vhGetFreeBufferNode(vPDBuffer buffer)
+{
+	/* any node in the free list has a free slot */
+	if (buffer->freeHead) return buffer->freeHead;
+	return vhAppendBufferNode(buffer);
+}
+
+static __forceinline void vhOnNodeSlotsFreed(vPDBuffer buffer, vPDBufferNode node,
+	vUI64 chunk, vUI64 freedCount)
+{
+	/* node has rejoined the nodes with free slots */
+	vhFreeListPush(buffer, node);
+	if (chunk < node->freeHint) node->freeHint = chunk;
+
+	/* node has just become empty */
+	if (freedCount > 0 && node->elementCount == 0) buffer->emptyNodeCount++;
+}
+
+static __forceinline vUI64 vhDBufferTrimArenaTo(vPDBuffer buffer, vUI32 emptyNodesToKeep)
+{
+	vUI64 bytesReclaimed = 0;
+
+	/* arena nodes stay contiguous, so only trailing nodes go */
+	while (buffer->tail != NULL && buffer->tail->elementCount == 0 &&
+		buffer->emptyNodeCount > emptyNodesToKeep)
 	{
-		vUI64 chunk, bit;
-		vhMapIndexToUseField(i, &chunk, &bit);
-		if (_bittest64(node->useField + chunk, bit) == FALSE)
+		vPDBufferNode node = buffer->tail;
+
+		/* previous node sits directly below in the arena */
+		vPDBufferNode previous = (node == buffer->head) ? NULL :
+			(vPDBufferNode)((vPBYTE)node - buffer->nodeAlignment);
+		if (previous == NULL)	buffer->head   = NULL;
+		else					previous->next = NULL;
+		buffer->tail = previous;
+
+		vhFreeListUnlink(buffer, node);
+		buffer->nodeCount--;
+		buffer->emptyNodeCount--;
+
+		bytesReclaimed += buffer->nodeCommitBytes;
+		vhDestroyBufferNode(node);
+	}
+
+	return bytesReclaimed;
+}
+
+static __forceinline vUI64 vhDBufferTrimTo(vPDBuffer buffer, vUI32 emptyNodesToKeep)
+{
+	if (buffer->arenaBase != NULL)
+		return vhDBufferTrimArenaTo(buffer, emptyNodesToKeep);
+
+	vUI64 bytesReclaimed = 0;
+
+	vPDBufferNode previous = NULL;
+	vPDBufferNode node = buffer->head;
+	while (node != NULL && buffer->emptyNodeCount > emptyNodesToKeep)
+	{
+		vPDBufferNode next = node->next;
+
+		/* skip nodes which hold elements */
+		if (node->elementCount != 0)
+		{
+			previous = node;
+			node = next;
+			continue;
+		}
+
+		/* unlink from node list, keeping head and tail valid */
+		if (previous == NULL)	buffer->head   = next;
+		else					previous->next = next;
+		if (buffer->tail == node) buffer->tail = previous;
+
+		vhFreeListUnlink(buffer, node);
+		buffer->nodeCount--;
+		buffer->emptyNodeCount--;
+
+		bytesReclaimed += buffer->nodeCommitBytes;
+		vhDestroyBufferNode(node);
+
+		node = next;
+	}
+
+	return bytesReclaimed;
+}
+
+static __forceinline void vhDBufferAutoTrim(vPDBuffer buffer)
+{
+	if (buffer->trimHighWatermark == 0) return;
+	if (buffer->emptyNodeCount <= buffer->trimHighWatermark) return;
+
+	vhDBufferTrimTo(buffer, buffer->trimLowWatermark);
+}
+
+static __forceinline vUI64 vhDBufferFreeMask(vPDBuffer buffer, vUI64 chunk, vUI64 word)
+{
+	vUI64 freeMask = ~word;
+
+	/* mask out bits past node size in the last word */
+	vUI64 tailBits = buffer->nodeSize & 0b111111;
+	if (chunk == (buffer->nodeSize >> 0x06))
+		freeMask &= (tailBits != 0) ? ((1ULL << tailBits) - 1) : 0;
+
+	return freeMask;
+}
+
+static __forceinline vUI64 vhClaimFreeNodeRun(vPDBufferNode node, vUI64 maxCount,
+	vPUI64 chunkOut)
+{
+	vPDBuffer buffer = node->parent;
+	if (node->elementCount >= buffer->nodeSize) return 0;
+
+	/* words below the hint are known to be full */
+	vUI64 wordCount = (buffer->nodeSize + 0x3F) >> 0x06;
+	for (vUI64 chunk = node->freeHint; chunk < wordCount; chunk++)
+	{
+		node->freeHint = chunk;
+
+		vUI64 freeMask = vhDBufferFreeMask(buffer, chunk, node->useField[chunk]);
+		if (freeMask == 0) continue;
+
+		/* take the lowest maxCount free bits of this word */
+		vUI64 claimMask = freeMask;
+		if (__popcnt64(freeMask) > maxCount)
+		{
+			claimMask = 0;
+			for (vUI64 i = 0; i < maxCount; i++)
+			{
+				vUI64 lowBit = freeMask & (~freeMask + 1);
+				claimMask |= lowBit;
+				freeMask  ^= lowBit;
+			}
+		}
+
+		/* node is no longer empty */
+		if (node->elementCount == 0) buffer->emptyNodeCount--;
+
+		node->useField[chunk] |= claimMask;
+		node->elementCount += __popcnt64(claimMask);
+
+		/* full nodes leave the free list */
+		if (node->elementCount >= buffer->nodeSize)
+			vhFreeListUnlink(buffer, node);
+
+		*chunkOut = chunk;
+		return claimMask;
+	}
+
+	return 0;
+}
+
+static __forceinline void vhDBufferZeroRuns(vPDBufferNode node, vUI64 chunk, vUI64 mask)
+{
+	vPDBuffer buffer = node->parent;
+
+	/* zero each run of contiguous slots with a single store */
+	while (mask != 0)
+	{
+		unsigned long start;
+		_BitScanForward64(&start, mask);
+
+		vUI64 shifted = ~(mask >> start);
+		unsigned long runLength = 64 - start;
+		if (shifted != 0) _BitScanForward64(&runLength, shifted);
+
+		vUI64 index = vhMapUseFieldToIndex(chunk, start);
+		vZeroMemory((vPBYTE)node->block + (index * buffer->elementSizeBytes),
+			(vUI64)runLength * buffer->elementSizeBytes);
+
+		if (start + runLength >= 64) break;
+		mask &= ~0ULL << (start + runLength);
+	}
+}
+
+static __forceinline vPDBufferNode vhFindElementNode(vPDBuffer buffer, vPTR element)
+{
+	/* owning node sits at the aligned base below the element */
+	vPDBufferNode node = (vPDBufferNode)((vUI64)element & ~(buffer->nodeAlignment - 1));
+
+	/* arena nodes past the committed ones have no header to read */
+	if (buffer->arenaBase != NULL &&
+		((vPBYTE)node < buffer->arenaBase || (vPBYTE)node >= buffer->arenaBase +
+		((vUI64)buffer->arenaNodesCommitted * buffer->nodeAlignment))) return NULL;
+
+	/* other nodes have their own reservation, the masked base	*/
+	/* may be unmapped unless it is one of this buffer's nodes	*/
+	if (buffer->arenaBase == NULL &&
+		vhNodeAddressContains(buffer, node) == FALSE) return NULL;
+
+	if (node->parent != buffer) return NULL;
+	if ((vPBYTE)element <  (vPBYTE)node->block ||
+		(vPBYTE)element >= (vPBYTE)node->block +
+		(buffer->elementSizeBytes * buffer->nodeSize)) return NULL;
+
+	return node;
+}
+
+static void vhDBufferIterateChunk(vPDBufferIterateChunk chunk)
+{
+	vPDBuffer buffer = _vcore.dbuffers + chunk->dBuffer;
+	vUI64 wordsPerNode = ((vUI64)buffer->nodeSize + 0x3F) >> 0x06;
+
+	vPDBufferNode node = chunk->startNode;
+	vUI64 word = chunk->startWord;
+	for (vUI64 i = 0; i < chunk->wordCount; i++, word++)
+	{
+		/* continue into the next node */
+		if (word == wordsPerNode)
 		{
-			/* set used and return index */
-			_bittestandset64(node->useField + chunk, bit);
+			node = node->next;
+			word = 0;
+		}
+		if (node == NULL) break;
+		if (node->elementCount == 0) continue;
 
-			node->elementCount++; /* increment element count */
+		/* walk set bits of the word */
+		vUI64 live = node->useField[word];
+		while (live != 0)
+		{
+			unsigned long bit;
+			_BitScanForward64(&bit, live);
+			live &= live - 1;
 
-			return i;
+			vPBYTE element = (vPBYTE)node->block +
+				(buffer->elementSizeBytes * vhMapUseFieldToIndex(word, bit));
+			chunk->function(chunk->dBuffer, element, chunk->input, chunk->chunkData);
 		}
-			
 	}
+}
 
-	/* on nothing found, return -1 */
-	return ~0;
+static void vhDBufferIterateChunkTask(vPWorker worker, vPTR persistentData,
+	vPDBufferIterateChunk chunk)
+{
+	vhDBufferIterateChunk(chunk);
 }
 
 
@@ -120,7 +560,23 @@ VAPI vHNDL vCreateDBuffer(const char* dBufferName, vUI16 elementSize,
 	dBuffer->elementSizeBytes = elementSize;
 	dBuffer->nodeSize = nodeSize;
 	vCoreTime(&dBuffer->timeCreated);
-	InitializeCriticalSection(&dBuffer->rwPermission);
+
+	/* node layout is header, use field, then element block */
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	vUI64 pageSize  = systemInfo.dwPageSize;
+	vUI64 nodeBytes = sizeof(vDBufferNode) +
+		((((vUI64)nodeSize >> 0x06) + 1) * sizeof(vUI64)) +
+		((vUI64)nodeSize * elementSize);
+	dBuffer->nodeCommitBytes = (nodeBytes + pageSize - 1) & ~(pageSize - 1);
+	dBuffer->nodeGranularity = systemInfo.dwAllocationGranularity;
+
+	/* round node alignment up to a power of two */
+	unsigned long highBit;
+	_BitScanReverse64(&highBit, dBuffer->nodeCommitBytes);
+	dBuffer->nodeAlignment = 1ULL << highBit;
+	if (dBuffer->nodeAlignment < dBuffer->nodeCommitBytes) dBuffer->nodeAlignment <<= 1;
+	vRWLockInitialize(&dBuffer->rwPermission);
 
 	/* setup callbacks */
 	dBuffer->initializeFunc = initializeFunc;
@@ -129,6 +585,13 @@ VAPI vHNDL vCreateDBuffer(const char* dBufferName, vUI16 elementSize,
 	/* setup first node */
 	dBuffer->head = NULL;
 	dBuffer->tail = NULL;
+	dBuffer->freeHead = NULL;
+	dBuffer->nodeCount		= 0;
+	dBuffer->emptyNodeCount = 0;
+
+	/* auto trimming is off by default */
+	dBuffer->trimHighWatermark = 0;
+	dBuffer->trimLowWatermark  = 0;
 
 	vCoreUnlock(); /* UNSYNC */
 
@@ -140,6 +603,41 @@ VAPI vHNDL vCreateDBuffer(const char* dBufferName, vUI16 elementSize,
 	return index;
 }
 
+VAPI vHNDL vCreateDBufferArena(const char* dBufferName, vUI16 elementSize,
+	vUI32 nodeSize, vUI32 maxNodes, vPFDBUFFERINITIALIZEELEMENT initializeFunc,
+	vPFDBUFFERDESTROYELEMENT destroyFunc)
+{
+	vHNDL index = vCreateDBuffer(dBufferName, elementSize, nodeSize,
+		initializeFunc, destroyFunc);
+	vPDBuffer dBuffer = _vcore.dbuffers + index;
+
+	vDBufferLock(index); /* SYNC */
+
+	/* reserve all nodes up front, committed one node at a time */
+	vUI64 reserveSize = ((vUI64)maxNodes * dBuffer->nodeAlignment) + dBuffer->nodeAlignment;
+	dBuffer->arenaReservation = VirtualAlloc(NULL, reserveSize, MEM_RESERVE, PAGE_NOACCESS);
+	if (dBuffer->arenaReservation == NULL)
+	{
+		vLogWarningFormatted(__func__,
+			"Could not reserve arena for dynamic buffer '%s'. "
+			"Falling back to individual nodes.", dBuffer->name);
+		vDBufferUnlock(index); /* UNSYNC */
+		return index;
+	}
+
+	dBuffer->arenaBase = (vPBYTE)(((vUI64)dBuffer->arenaReservation +
+		dBuffer->nodeAlignment - 1) & ~(dBuffer->nodeAlignment - 1));
+	dBuffer->arenaMaxNodes		 = maxNodes;
+	dBuffer->arenaNodesCommitted = 0;
+
+	vDBufferUnlock(index); /* UNSYNC */
+
+	vLogInfoFormatted(__func__, "Dynamic buffer '%s' uses an arena of %d nodes.",
+		dBuffer->name, maxNodes);
+
+	return index;
+}
+
 VAPI vBOOL vDestroyDBuffer(vHNDL dBuffer)
 {
 	if (dBuffer < 0 || dBuffer > MAX_DBUFFERS) return FALSE;
@@ -178,6 +676,49 @@ VAPI vBOOL vDestroyDBuffer(vHNDL dBuffer)
 		vhDestroyBufferNode(toDestroy);
 	}
 
+	/* free node table and slot generations */
+	if (buffer->nodeTable != NULL)
+	{
+		for (vUI32 i = 0; i < buffer->nodeTableUsed; i++)
+		{
+			vPDBufferNodeEntry entry = vhGetNodeEntry(buffer, i);
+			if (entry->generations) vFree(entry->generations);
+		}
+		for (vUI32 i = 0; i < DBUFFER_NODE_TABLE_PAGES; i++)
+		{
+			if (buffer->nodeTable[i]) vFree(buffer->nodeTable[i]);
+		}
+		vFree(buffer->nodeTable);
+		buffer->nodeTable	  = NULL;
+		buffer->nodeTableUsed = 0;
+	}
+
+	/* free node address set */
+	if (buffer->nodeAddresses != NULL)
+	{
+		vFree(buffer->nodeAddresses);
+		buffer->nodeAddresses		= NULL;
+		buffer->nodeAddressCapacity = 0;
+		buffer->nodeAddressCount	= 0;
+	}
+
+	/* release arena range */
+	if (buffer->arenaReservation != NULL)
+	{
+		VirtualFree(buffer->arenaReservation, 0, MEM_RELEASE);
+		buffer->arenaReservation = NULL;
+		buffer->arenaBase		 = NULL;
+	}
+
+	buffer->head	 = NULL;
+	buffer->tail	 = NULL;
+	buffer->freeHead = NULL;
+	buffer->nodeCount	   = 0;
+	buffer->emptyNodeCount = 0;
+
+	/* release buffer sync object */
+	vDBufferUnlock(dBuffer);
+
 	vLogInfoFormatted(__func__, "Destroyed dynamic buffer '%s'.", buffer->name);
 
 	vCoreUnlock();
@@ -190,13 +731,25 @@ VAPI vBOOL vDestroyDBuffer(vHNDL dBuffer)
 VAPI void vDBufferLock(vHNDL dBuffer)
 {
 	vPDBuffer buffer = &_vcore.dbuffers[dBuffer];
-	EnterCriticalSection(&buffer->rwPermission);
+	vRWLockExclusive(&buffer->rwPermission);
 }
 
 VAPI void vDBufferUnlock(vHNDL dBuffer)
 {
 	vPDBuffer buffer = &_vcore.dbuffers[dBuffer];
-	LeaveCriticalSection(&buffer->rwPermission);
+	vRWUnlockExclusive(&buffer->rwPermission);
+}
+
+VAPI void vDBufferLockShared(vHNDL dBuffer)
+{
+	vPDBuffer buffer = &_vcore.dbuffers[dBuffer];
+	vRWLockShared(&buffer->rwPermission);
+}
+
+VAPI void vDBufferUnlockShared(vHNDL dBuffer)
+{
+	vPDBuffer buffer = &_vcore.dbuffers[dBuffer];
+	vRWUnlockShared(&buffer->rwPermission);
 }
 
 
@@ -207,127 +760,306 @@ VAPI vPTR vDBufferAdd(vHNDL dBuffer, vPTR input)
 
 	vDBufferLock(dBuffer); /* SYNC */
 
+	/* take a slot from the first node with free slots */
+	vPDBufferNode node = vhGetFreeBufferNode(buffer);
+	vUI64 chunk;
+	vUI64 claimMask = vhClaimFreeNodeRun(node, 1, &chunk);
+	if (claimMask == 0)
+	{
+		/* SHOULD NEVER REACH HERE! */
+		vLogError(__func__, "Unexpected error while trying to add to dynamic buffer.");
+		vCoreFatalError(__func__, "Unexpected error while trying to add to dynamic buffer.");
+	}
+
+	unsigned long bit;
+	_BitScanForward64(&bit, claimMask);
+
+	/* on valid index, return PTR */
+	vUI64 slot = vhMapUseFieldToIndex(chunk, bit);
+	vPBYTE element = (vPBYTE)(node->block) + ((buffer->elementSizeBytes) * slot);
+	vZeroMemory(element, buffer->elementSizeBytes);
+	vhBumpSlotGeneration(node, slot);
+	buffer->elementCount++;
+
+	/* call initialization func (if exists) */
+	if (buffer->initializeFunc)
+		buffer->initializeFunc(dBuffer, element, input);
+
+	vDBufferUnlock(dBuffer); /* UNSYNC */
+
+	return element;
+}
+
+VAPI void vDBufferRemove(vHNDL dBuffer, vPTR element)
+{
+	vDBufferLock(dBuffer);
 
-	/* ensure head exists */
-	if (buffer->head == NULL)
+	vPDBuffer buffer = &_vcore.dbuffers[dBuffer];
+
+	/* find owning node from element address */
+	vPDBufferNode node = vhFindElementNode(buffer, element);
+	if (node == NULL)
 	{
-		buffer->head = vhCreateBufferNode(buffer);
-		buffer->tail = buffer->head;
+		vLogWarning(__func__, "Tried to remove element that is not in dynamic buffer.");
+		vDBufferUnlock(dBuffer);
+		return;
 	}
 
-	/* try add to each node */
-	vPDBufferNode currentNode = buffer->head;
+	/* get index using ptr math */
+	vUI32 nodeIndex = ((vPBYTE)element - (vPBYTE)node->block) / buffer->elementSizeBytes;
 
-	while(TRUE)
+	/* get bitfield chunk & bit using index */
+	vUI64 chunk, bit;
+	vhMapIndexToUseField(nodeIndex, &chunk, &bit);
+	if (_bittest64(node->useField + chunk, bit) == FALSE)
 	{
-		/* try to add to current Node */
-		vUI32 freeIndex = vhFindFreeBufferNodeIndex(currentNode);
+		vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+		vDBufferUnlock(dBuffer);
+		return;
+	}
 
-		/* on no free, go to next */
-		if (freeIndex == ~0)
-		{
-			vPDBufferNode nextNode = currentNode->next;
+	/* outstanding handles stop resolving before destruction */
+	vhBumpSlotGeneration(node, nodeIndex);
 
-			/* create node if missing */
-			if (nextNode == NULL)
-			{
-				nextNode = vhCreateBufferNode(buffer);
-				currentNode->next = nextNode;
-				buffer->tail = nextNode;
-			}
+	/* call destruction func (if exists) */
+	if (buffer->destroyFunc)
+		buffer->destroyFunc(dBuffer, element);
 
-			currentNode = nextNode;
+	/* set bit to be unused */
+	_bittestandreset64(node->useField + chunk, bit);
 
-			continue;
-		}
+	/* decrement element count */
+	node->elementCount -= 1;
+	buffer->elementCount -= 1;
+
+	vhOnNodeSlotsFreed(buffer, node, chunk, 1);
+	vhDBufferAutoTrim(buffer);
+
+	vDBufferUnlock(dBuffer);
+}
+
+VAPI vUI32 vDBufferAddBatch(vHNDL dBuffer, vUI32 count, vPTR* inputs, vPTR* elementsOut)
+{
+	vPDBuffer buffer = _vcore.dbuffers + dBuffer;
+
+	vDBufferLock(dBuffer); /* SYNC */
 
-		/* on valid index, return PTR */
-		vPBYTE element = (vPBYTE)(currentNode->block) + ((buffer->elementSizeBytes) * freeIndex);
-		vZeroMemory(element, buffer->elementSizeBytes);
-		buffer->elementCount++;
+	vUI32 added = 0;
 
-		/* call initialization func (if exists) */
-		if (buffer->initializeFunc)
-			buffer->initializeFunc(dBuffer, element, input);
+	while (added < count)
+	{
+		/* claim as many free slots as possible from one word */
+		vPDBufferNode currentNode = vhGetFreeBufferNode(buffer);
+		vUI64 chunk;
+		vUI64 claimMask = vhClaimFreeNodeRun(currentNode, count - added, &chunk);
+		if (claimMask == 0) break;
 
-		vDBufferUnlock(dBuffer); /* UNSYNC */
+		vhDBufferZeroRuns(currentNode, chunk, claimMask);
+		buffer->elementCount += __popcnt64(claimMask);
 
-		return element;
+		/* initialize in index order */
+		while (claimMask != 0)
+		{
+			unsigned long bit;
+			_BitScanForward64(&bit, claimMask);
+			claimMask &= claimMask - 1;
+
+			vUI64 slot = vhMapUseFieldToIndex(chunk, bit);
+			vPBYTE element = (vPBYTE)(currentNode->block) + (buffer->elementSizeBytes * slot);
+			vhBumpSlotGeneration(currentNode, slot);
+
+			if (buffer->initializeFunc)
+				buffer->initializeFunc(dBuffer, element, inputs ? inputs[added] : NULL);
+			if (elementsOut) elementsOut[added] = element;
+			added++;
+		}
 	}
 
-	/* SHOULD NEVER REACH HERE! */
-	vLogError(__func__, "Unexpected error while trying to add to dynamic buffer.");
-	vCoreFatalError(__func__, "Unexpected error while trying to add to dynamic buffer.");
+	vDBufferUnlock(dBuffer); /* UNSYNC */
+
+	return added;
 }
 
-VAPI void vDBufferRemove(vHNDL dBuffer, vPTR element)
+VAPI vUI32 vDBufferRemoveBatch(vHNDL dBuffer, vUI32 count, vPTR* elements)
 {
 	vDBufferLock(dBuffer);
 
 	vPDBuffer buffer = &_vcore.dbuffers[dBuffer];
 
-	vPDBufferNode node = buffer->head;
+	/* bits are released one node word at a time */
+	vPDBufferNode pendingNode = NULL;
+	vUI64 pendingChunk = 0;
+	vUI64 pendingMask  = 0;
+	vUI32 removed = 0;
 
-	/* iterate all nodes */
-	while (node != NULL)
+	for (vUI32 i = 0; i <= count; i++)
 	{
-		if ((vPBYTE)element >= (vPBYTE)node->block && 
-			(vPBYTE)element <= (vPBYTE)node->block + 
-			(buffer->elementSizeBytes * buffer->nodeSize))
+		vPDBufferNode node = NULL;
+		vUI64 chunk = 0, bit = 0;
+		if (i < count)
 		{
-			/* call destruction func (if exists) */
-			if (buffer->destroyFunc)
-				buffer->destroyFunc(dBuffer, element);
-
-			/* get index using ptr math */
-			vUI32 nodeIndex = ((vPBYTE)element - (vPBYTE)node->block) / buffer->elementSizeBytes;
+			node = vhFindElementNode(buffer, elements[i]);
+			if (node == NULL)
+			{
+				vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+				continue;
+			}
 
-			/* get bitfield chunk & bit using index */
-			vUI64 chunk, bit;
+			vUI32 nodeIndex = ((vPBYTE)elements[i] - (vPBYTE)node->block) /
+				buffer->elementSizeBytes;
 			vhMapIndexToUseField(nodeIndex, &chunk, &bit);
+		}
 
-			/* set bit to be unused */
-			_bittestandreset64(node->useField + chunk, bit);
-
-			/* decrement element count */
-			node->elementCount -= 1;
-			buffer->elementCount -= 1;
-
-			vDBufferUnlock(dBuffer);
+		/* flush pending word on word change or at end */
+		if ((node != pendingNode || chunk != pendingChunk) && pendingMask != 0)
+		{
+			vUI64 pendingCount = __popcnt64(pendingMask);
+			pendingNode->useField[pendingChunk] &= ~pendingMask;
+			pendingNode->elementCount -= pendingCount;
+			buffer->elementCount	  -= pendingCount;
+			vhOnNodeSlotsFreed(buffer, pendingNode, pendingChunk, pendingCount);
+			pendingMask = 0;
+		}
+		if (i == count) break;
+		pendingNode  = node;
+		pendingChunk = chunk;
 
-			return; /* end */
+		/* skip elements which are unused or already pending */
+		if (_bittest64(node->useField + chunk, bit) == FALSE ||
+			(pendingMask & (1ULL << bit)) != 0)
+		{
+			vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+			continue;
 		}
 
-		/* move to next block */
-		node = node->next;
+		vhBumpSlotGeneration(node, vhMapUseFieldToIndex(chunk, bit));
+		if (buffer->destroyFunc)
+			buffer->destroyFunc(dBuffer, elements[i]);
+
+		pendingMask |= (1ULL << bit);
+		removed++;
 	}
+
+	vhDBufferAutoTrim(buffer);
+
+	vDBufferUnlock(dBuffer);
+
+	return removed;
 }
 
 VAPI void vDBufferIterate(vHNDL dBuffer, vPFDBUFFERITERATEFUNC function, vPTR input)
 {
-	vDBufferLock(dBuffer);
+	vDBufferLockShared(dBuffer);
 	vPDBuffer buffer = &_vcore.dbuffers[dBuffer];
 
-	/* walk every node */
+	vUI64 wordsPerNode = ((vUI64)buffer->nodeSize + 0x3F) >> 0x06;
+	vUI64 remaining    = buffer->elementCount;
+
+	/* walk nodes until every element was visited */
 	vPDBufferNode node = buffer->head;
-	while (node != NULL)
+	while (node != NULL && remaining != 0)
 	{
-		/* check every element */
-		for (vUI64 i = 0; i < buffer->nodeSize; i++)
+		vUI64 nodeRemaining = node->elementCount;
+
+		/* skip zero words, walk set bits of the rest */
+		for (vUI64 chunk = 0; chunk < wordsPerNode && nodeRemaining != 0; chunk++)
 		{
-			vUI64 chunk, index;
-			vhMapIndexToUseField(i, &chunk, &index);
+			vUI64 live = node->useField[chunk];
+			while (live != 0)
+			{
+				unsigned long bit;
+				_BitScanForward64(&bit, live);
+				live &= live - 1;
+
+				function(dBuffer, (vPBYTE)node->block + 
+					(vhMapUseFieldToIndex(chunk, bit) * buffer->elementSizeBytes), input);
+				nodeRemaining--;
+				remaining--;
+			}
+		}
+
+		node = node->next;
+	}
+
+	vDBufferUnlockShared(dBuffer);
+}
+
+VAPI void vDBufferIterateParallel(vHNDL dBuffer, vPFDBUFFERITERATEPARALLELFUNC function,
+	vPTR input, vPWorker* workers, vUI32 workerCount, vUI64 chunkDataSize,
+	vPFITERATEREDUCEFUNC reduceFunc)
+{
+	if (function == NULL)
+	{
+		vLogWarning(__func__, "Tried to iterate over dynamic buffer with NULL function.");
+		return;
+	}
+
+	/* writers are held off until every chunk is done. the	*/
+	/* calling thread runs unclaimed chunks itself, so a cycle	*/
+	/* waiting on this lock cannot stall the pass				*/
+	vDBufferLockShared(dBuffer);
+	vPDBuffer buffer = &_vcore.dbuffers[dBuffer];
 
-			/* if unused, skip */
-			if (_bittest64(&node->useField[chunk], index) == FALSE) continue;
+	/* split all node words into a few chunks per worker */
+	vUI64 wordsPerNode = ((vUI64)buffer->nodeSize + 0x3F) >> 0x06;
+	vUI64 totalWords   = (vUI64)buffer->nodeCount * wordsPerNode;
+	if (workers == NULL) workerCount = 0;
+	vUI64 chunkCount = max(1, (vUI64)workerCount * WORKER_ITERATE_CHUNKS_PER_WORKER);
+	chunkCount = min(chunkCount, max(1, totalWords));
+	vUI64 wordsPerChunk = max(1, (totalWords + chunkCount - 1) / chunkCount);
+	chunkCount = max(1, (totalWords + wordsPerChunk - 1) / wordsPerChunk);
 
-			function(dBuffer, (vPBYTE)node->block + (i * buffer->elementSizeBytes), input);
+	/* chunk descriptors, task inputs and zeroed chunk scratch */
+	vPDBufferIterateChunk chunks = vAllocZeroed(sizeof(vDBufferIterateChunk) * chunkCount);
+	vPTR* chunkInputs = vAllocZeroed(sizeof(vPTR) * chunkCount);
+	vPBYTE chunkData  = chunkDataSize ? vAllocZeroed(chunkDataSize * chunkCount) : NULL;
+
+	vPDBufferNode node = buffer->head;
+	vUI64 nodeWord = 0;
+	for (vUI64 i = 0; i < chunkCount; i++)
+	{
+		chunks[i].dBuffer   = dBuffer;
+		chunks[i].function  = function;
+		chunks[i].input	    = input;
+		chunks[i].chunkData = chunkData ? chunkData + (i * chunkDataSize) : NULL;
+		chunks[i].startNode = node;
+		chunks[i].startWord = nodeWord;
+		chunks[i].wordCount = min(wordsPerChunk, totalWords - (i * wordsPerChunk));
+		chunkInputs[i] = chunks + i;
+
+		/* advance start position to the next chunk */
+		nodeWord += chunks[i].wordCount;
+		while (node != NULL && nodeWord >= wordsPerNode)
+		{
+			node = node->next;
+			nodeWord -= wordsPerNode;
 		}
+	}
 
-		node = node->next;
+	/* run on workers, or inline when none were given */
+	if (workerCount == 0)
+	{
+		for (vUI64 i = 0; i < chunkCount; i++)
+			vhDBufferIterateChunk(chunks + i);
+	}
+	else
+	{
+		vWorkerDispatchTaskGroup(workers, workerCount, vhDBufferIterateChunkTask,
+			chunkInputs, chunkCount);
 	}
 
-	vDBufferUnlock(dBuffer);
+	/* combine per-chunk results on the calling thread */
+	if (reduceFunc)
+	{
+		for (vUI64 i = 0; i < chunkCount; i++)
+			reduceFunc(chunks[i].chunkData, input);
+	}
+
+	vFree(chunks);
+	vFree(chunkInputs);
+	if (chunkData) vFree(chunkData);
+
+	vDBufferUnlockShared(dBuffer);
 }
 
 VAPI void vDBufferClear(vHNDL dBuffer) 
@@ -342,42 +1074,154 @@ VAPI void vDBufferClear(vHNDL dBuffer)
 		return;
 	}
 		
-
+	vUI64 wordsPerNode = ((vUI64)buffer->nodeSize + 0x3F) >> 0x06;
 	vPDBufferNode node = buffer->head;
 
 	/* walk all nodes and set their fields to NULL */
 	while (node != NULL)
 	{
-		for (vUI64 i = 0; i < buffer->nodeSize; i++)
+		vUI64 nodeElementCount = node->elementCount;
+		if (nodeElementCount == 0)
 		{
-			vUI64 chunk, bit;
-			vhMapIndexToUseField(i, &chunk, &bit);
-
-			/* if index is empty, skip */
-			if (_bittest64(node->useField + chunk, bit) == FALSE) continue;
-
-			/* get element pointer and destroy (if possible) */
-			vPBYTE element = (vPBYTE)node->block + (i * buffer->elementSizeBytes);
-			if (buffer->destroyFunc)
-				buffer->destroyFunc(dBuffer, element);
-
-			node->elementCount--;
-			buffer->elementCount--;
-			
-			/* set flag to unused */
-			_bittestandreset64(node->useField + chunk, bit);
+			node = node->next;
+			continue;
 		}
 
+		/* retire handles and destroy every live element */
+		for (vUI64 chunk = 0; chunk < wordsPerNode; chunk++)
+		{
+			vUI64 live = node->useField[chunk];
+			while (live != 0)
+			{
+				unsigned long bit;
+				_BitScanForward64(&bit, live);
+				live &= live - 1;
+
+				vUI64 slot = vhMapUseFieldToIndex(chunk, bit);
+				vhBumpSlotGeneration(node, slot);
+				if (buffer->destroyFunc)
+					buffer->destroyFunc(dBuffer, (vPBYTE)node->block + 
+						(slot * buffer->elementSizeBytes));
+			}
+		}
+
+		/* release whole use field at once */
+		vZeroMemory(node->useField, wordsPerNode * sizeof(vUI64));
+		node->elementCount    = 0;
+		buffer->elementCount -= nodeElementCount;
+
+		vhOnNodeSlotsFreed(buffer, node, 0, nodeElementCount);
+
 		node = node->next;
 	}
 
+	vhDBufferAutoTrim(buffer);
+
 	vDBufferUnlock(dBuffer);
 }
 
 
+/* ========== ELEMENT HANDLES					==========	*/
+VAPI vEHNDL vDBufferGetHandle(vHNDL dBuffer, vPTR element)
+{
+	vDBufferLockShared(dBuffer); /* SYNC */
+	vPDBuffer buffer = _vcore.dbuffers + dBuffer;
+
+	vPDBufferNode node = vhFindElementNode(buffer, element);
+	if (node == NULL)
+	{
+		vLogWarning(__func__, "Tried to get handle of element that is not in dynamic buffer.");
+		vDBufferUnlockShared(dBuffer); /* UNSYNC */
+		return DBUFFER_HANDLE_INVALID;
+	}
+
+	vUI64 slot = ((vPBYTE)element - (vPBYTE)node->block) / buffer->elementSizeBytes;
+	vEHNDL handle = ((vUI64)node->generations[slot] << DBUFFER_HANDLE_GENERATION_SHIFT) |
+		((vUI64)node->nodeIndex << DBUFFER_HANDLE_NODE_SHIFT) | slot;
+
+	vDBufferUnlockShared(dBuffer); /* UNSYNC */
+
+	return handle;
+}
+
+VAPI vPTR   vDBufferResolve(vHNDL dBuffer, vEHNDL handle)
+{
+	vPDBuffer buffer = _vcore.dbuffers + dBuffer;
+
+	vUI64 slot		 = handle & DBUFFER_HANDLE_FIELD_MASK;
+	vUI64 nodeIndex	 = (handle >> DBUFFER_HANDLE_NODE_SHIFT) & DBUFFER_HANDLE_FIELD_MASK;
+	vUI16 generation = (vUI16)(handle >> DBUFFER_HANDLE_GENERATION_SHIFT);
+	if (generation == 0 || slot >= buffer->nodeSize) return NULL;
+
+	/* no lock is taken and node memory is never read. entries	*/
+	/* and their generations outlive trimmed nodes, so the node	*/
+	/* pointer is only used to compute the element's address		*/
+	vPDBufferNodeEntry entry = vhGetNodeEntry(buffer, nodeIndex);
+	if (entry == NULL) return NULL;
+	vPBYTE node = ReadPointerAcquire((PVOID const volatile*)&entry->node);
+	if (node == NULL) return NULL;
+
+	/* generations move on every add and remove, a match means	*/
+	/* the slot is still live from the add the handle came from	*/
+	if (*(volatile vUI16*)(entry->generations + slot) != generation) return NULL;
+
+	return node + vhNodeBlockOffset(buffer) + (slot * buffer->elementSizeBytes);
+}
+
+
+/* ========== MEMORY MANAGEMENT					==========	*/
+VAPI vUI64 vDBufferTrim(vHNDL dBuffer, vUI32 emptyNodesToKeep)
+{
+	vDBufferLock(dBuffer); /* SYNC */
+	vPDBuffer buffer = _vcore.dbuffers + dBuffer;
+
+	/* unlink and free empty nodes past the amount to keep */
+	vUI64 bytesReclaimed = vhDBufferTrimTo(buffer, emptyNodesToKeep);
+
+	vDBufferUnlock(dBuffer); /* UNSYNC */
+
+	return bytesReclaimed;
+}
+
+VAPI void vDBufferSetTrimPolicy(vHNDL dBuffer, vUI32 highWatermark,
+	vUI32 lowWatermark)
+{
+	vDBufferLock(dBuffer); /* SYNC */
+	vPDBuffer buffer = _vcore.dbuffers + dBuffer;
+
+	/* low watermark can't exceed the high watermark */
+	if (lowWatermark > highWatermark)
+	{
+		vLogWarning(__func__, "Trim low watermark is above high watermark. "
+			"Clamping low watermark.");
+		lowWatermark = highWatermark;
+	}
+
+	/* high watermark of zero disables auto trimming */
+	buffer->trimHighWatermark = highWatermark;
+	buffer->trimLowWatermark  = lowWatermark;
+
+	vhDBufferAutoTrim(buffer);
+
+	vDBufferUnlock(dBuffer); /* UNSYNC */
+}
+
+
 /* ========== BUFFER INFORMATION				==========	*/
 VAPI vUI32 vDBufferGetElementCount(vHNDL dBuffer)
 {
 	vPDBuffer buffer = _vcore.dbuffers + dBuffer;
 	return buffer->elementCount;
+}
+
+VAPI vUI32 vDBufferGetNodeCount(vHNDL dBuffer)
+{
+	vPDBuffer buffer = _vcore.dbuffers + dBuffer;
+	return buffer->nodeCount;
+}
+
+VAPI vUI32 vDBufferGetEmptyNodeCount(vHNDL dBuffer)
+{
+	vPDBuffer buffer = _vcore.dbuffers + dBuffer;
+	return buffer->emptyNodeCount;
 }
\ No newline at end of file
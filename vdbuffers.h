@@ -13,22 +13,52 @@
 VAPI vHNDL vCreateDBuffer(const char* dBufferName, vUI16 elementSize, 
 	vUI32 nodeSize, vPFDBUFFERINITIALIZEELEMENT initializeFunc,
 	vPFDBUFFERDESTROYELEMENT destroyFunc);
+VAPI vHNDL vCreateDBufferArena(const char* dBufferName, vUI16 elementSize,
+	vUI32 nodeSize, vUI32 maxNodes, vPFDBUFFERINITIALIZEELEMENT initializeFunc,
+	vPFDBUFFERDESTROYELEMENT destroyFunc);
 VAPI vBOOL vDestroyDBuffer(vHNDL dBuffer);
 
 
 /* ========== SYNCHRONIZATION					==========	*/
 VAPI void vDBufferLock(vHNDL dBuffer);
 VAPI void vDBufferUnlock(vHNDL dBuffer);
+VAPI void vDBufferLockShared(vHNDL dBuffer);
+VAPI void vDBufferUnlockShared(vHNDL dBuffer);
 
 
 /* ========== ELEMENT MANIPULATION				==========	*/
 VAPI vPTR vDBufferAdd(vHNDL dBuffer, vPTR input);
 VAPI void vDBufferRemove(vHNDL dBuffer, vPTR element);
+VAPI vUI32 vDBufferAddBatch(vHNDL dBuffer, vUI32 count, vPTR* inputs, vPTR* elementsOut);
+VAPI vUI32 vDBufferRemoveBatch(vHNDL dBuffer, vUI32 count, vPTR* elements);
+/* iterate callbacks run under the shared lock and must not	*/
+/* add, remove or clear on the buffer being iterated, that is	*/
+/* a fatal error. record changes and apply them afterwards	*/
 VAPI void vDBufferIterate(vHNDL dBuffer, vPFDBUFFERITERATEFUNC function, vPTR input);
+VAPI void vDBufferIterateParallel(vHNDL dBuffer, vPFDBUFFERITERATEPARALLELFUNC function,
+	vPTR input, vPWorker* workers, vUI32 workerCount, vUI64 chunkDataSize,
+	vPFITERATEREDUCEFUNC reduceFunc);
 VAPI void vDBufferClear(vHNDL dBuffer);
 
 
+/* ========== ELEMENT HANDLES					==========	*/
+/* resolving takes no lock and never reads node memory, so it	*/
+/* is safe against concurrent removes and trims. it returns		*/
+/* NULL once the element is removed, but a returned element		*/
+/* is only usable while the caller keeps it from being removed	*/
+VAPI vEHNDL vDBufferGetHandle(vHNDL dBuffer, vPTR element);
+VAPI vPTR   vDBufferResolve(vHNDL dBuffer, vEHNDL handle);
+
+
+/* ========== MEMORY MANAGEMENT					==========	*/
+VAPI vUI64 vDBufferTrim(vHNDL dBuffer, vUI32 emptyNodesToKeep);
+VAPI void  vDBufferSetTrimPolicy(vHNDL dBuffer, vUI32 highWatermark,
+	vUI32 lowWatermark);
+
+
 /* ========== BUFFER INFORMATION				==========	*/
 VAPI vUI32 vDBufferGetElementCount(vHNDL dBuffer);
+VAPI vUI32 vDBufferGetNodeCount(vHNDL dBuffer);
+VAPI vUI32 vDBufferGetEmptyNodeCount(vHNDL dBuffer);
 
 #endif
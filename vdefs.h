@@ -40,12 +40,58 @@
 #define BUFF_MASSIVE	0x200
 
 #define COMPONENTS_MAX			0x100
+#define COMPONENT_SIGNATURE_WORDS	(COMPONENTS_MAX >> 6)
 #define VOBJECT_NODE_SIZE		0x800
 #define VOBJECT_MAX_COMPONENTS	0x10
 
+/* small object attributes are pooled per component, larger	*/
+/* ones use the heap. a pool node commits NODE_SIZE elements	*/
+/* at once, so the cap keeps one node within 256KB			*/
+#define COMPONENT_ATTRIBUTE_NODE_SIZE	0x100
+#define COMPONENT_ATTRIBUTE_POOL_MAX	0x400
+
+/* archetype storage keeps attributes of objects with the same	*/
+/* component set in chunked tables, one column per component	*/
+#define OBJECT_STORAGE_SCATTERED	0x00
+#define OBJECT_STORAGE_ARCHETYPE	0x01
+#define MAX_ARCHETYPES				0x100
+#define ARCHETYPE_CHUNK_BYTES		0x4000
+#define ARCHETYPE_COLUMN_ALIGNMENT	0x10
+
+#define MAX_PREFABS					0x100
+
+/* transform kernel instruction set levels */
+#define TRANSFORM_SIMD_SCALAR		0x00
+#define TRANSFORM_SIMD_SSE41		0x01
+#define TRANSFORM_SIMD_AVX2			0x02
+#define TRANSFORM_SIMD_BEST			0xFF
+#define TRANSFORM_SOA_ALIGNMENT		0x08	/* capacity multiple, in floats */
+
+#define HIERARCHY_ROW_NONE			0xFFFFFFFF
+
+/* hierarchy levels at least this wide are composed in parallel */
+#define HIERARCHY_PARALLEL_MIN_ROWS	0x400
+
+/* queries cache objects matching include/exclude component sets */
+#define MAX_QUERIES				0x40
+#define QUERY_INITIAL_CAPACITY	0x40
+
+/* systems are split into chunks of at least this many objects */
+#define MAX_SYSTEMS					0x40
+#define SYSTEM_MIN_CHUNK_OBJECTS	0x40
+
+/* structural changes recorded by workers, applied in batches */
+#define COMMAND_CREATE_OBJECT		0x00
+#define COMMAND_ADD_COMPONENT		0x01
+#define COMMAND_REMOVE_COMPONENT	0x02
+#define COMMAND_DESTROY_OBJECT		0x03
+#define COMMAND_INITIAL_CAPACITY	0x40
+#define COMMAND_PENDING_NODE		DBUFFER_HANDLE_FIELD_MASK	/* never a real node	*/
+
 #define WORKERS_MAX						 0x40
 #define WORKER_TASKLIST_NODE_SIZE		 0x100
 #define WORKER_COMPONENT_CYCLE_NODE_SIZE 0x200
+#define WORKER_ITERATE_CHUNKS_PER_WORKER 0x04
 
 #define HEAP_ALLOCATE_MIN NULL
 #define HEAP_ALLOCATE_MAX NULL
@@ -57,9 +103,38 @@
 #define MAX_BUFFERS		0x800
 #define MAX_DBUFFERS	0x800
 
+/* dbuffer element handles pack slot (bits 0-23), node index	*/
+/* (bits 24-47) and generation (bits 48-63). zero is invalid	*/
+#define DBUFFER_HANDLE_INVALID			0ULL
+#define DBUFFER_HANDLE_NODE_SHIFT		24
+#define DBUFFER_HANDLE_GENERATION_SHIFT	48
+#define DBUFFER_HANDLE_FIELD_MASK		0xFFFFFFULL
+#define DBUFFER_NODE_TABLE_PAGE_SIZE	0x400
+#define DBUFFER_NODE_TABLE_PAGES		0x400
+#define DBUFFER_NODE_ADDRESS_MIN		0x40
+
+/* lock-free buffers claim slots with CAS and skip all locking on	*/
+/* add/remove. iteration is not synchronized against add/remove	*/
+#define BUFFER_FLAG_LOCKFREE	0x01
+
+/* magazine buffers cache a small batch of slots per thread. cached	*/
+/* slots go back to the buffer on overflow, flush or thread exit	*/
+#define BUFFER_FLAG_MAGAZINE	0x02
+#define BUFFER_MAGAZINE_SIZE	0x20
+
+/* dense buffers keep all elements packed at the front of data by	*/
+/* moving the last element into each removed slot					*/
+#define BUFFER_FLAG_DENSE		0x04
+
+#define MAX_LBUFFERS			0x100
+#define LBUFFER_SEGMENT_SIZE	0x1000	/* elements, multiple of 64	*/
+
 #define MAX_LOCKS		0x800
 #define UNUSED_LOCK		0xDEAD
 
+/* reader/writer locks one thread can hold shared at a time */
+#define RWLOCK_SHARED_HELD_MAX	0x20
+
 /* ========== ENTRY TYPES						==========	*/
 #define ENTRY_UNUSED	0x00
 #define ENTRY_INFO		0x01
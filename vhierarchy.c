@@ -0,0 +1,473 @@
+
+/* ========== <vhierarchy.c>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vhierarchy.h"
+
+
+/* ========== HELPER							==========	*/
+static __forceinline vPObject vhHierarchyNextInSubtree(vPObject root, vPObject node)
+{
+	/* pre-order walk over child lists, NULL once past root */
+	if (node->firstChild) return node->firstChild;
+	while (node != root && node->nextSibling == NULL) node = node->parent;
+	return (node == root) ? NULL : node->nextSibling;
+}
+
+static void vhHierarchyLink(vPObject object, vPObject parent)
+{
+	object->parent		= parent;
+	object->prevSibling = NULL;
+	object->nextSibling = NULL;
+	if (parent == NULL) return;
+
+	object->nextSibling = parent->firstChild;
+	if (parent->firstChild) parent->firstChild->prevSibling = object;
+	parent->firstChild = object;
+}
+
+static void vhHierarchyUnlink(vPObject object)
+{
+	if (object->prevSibling) object->prevSibling->nextSibling = object->nextSibling;
+	else if (object->parent) object->parent->firstChild		  = object->nextSibling;
+	if (object->nextSibling) object->nextSibling->prevSibling = object->prevSibling;
+
+	object->parent		= NULL;
+	object->prevSibling = NULL;
+	object->nextSibling = NULL;
+}
+
+static void vhHierarchyRefreshSubtree(vPHierarchy hierarchy, vPObject root)
+{
+	/* fix depths below root and mark every row for recompute */
+	root->depth = root->parent ? root->parent->depth + 1 : 0;
+	for (vPObject node = root; node != NULL; node = vhHierarchyNextInSubtree(root, node))
+	{
+		if (node != root) node->depth = node->parent->depth + 1;
+		if (node->hasHierarchyRow) hierarchy->dirty[node->hierarchyRow] = TRUE;
+	}
+	hierarchy->orderDirty = TRUE;
+}
+
+static void vhHierarchyReserveRows(vPHierarchy hierarchy, vUI32 rows)
+{
+	if (rows <= hierarchy->rowCapacity) return;
+
+	vUI32 newCapacity = max(rows, max(TRANSFORM_SOA_ALIGNMENT, hierarchy->rowCapacity << 1));
+	vUI32 rowCount	  = hierarchy->locals.count;
+
+	vPObject* newObjects	= vAllocZeroed(sizeof(vPObject) * newCapacity);
+	vPUI32	  newParentRows = vAllocZeroed(sizeof(vUI32) * newCapacity);
+	vPBYTE	  newDirty		= vAllocZeroed(sizeof(vBYTE) * newCapacity);
+	if (hierarchy->objects)
+	{
+		vMemCopy(newObjects, hierarchy->objects, sizeof(vPObject) * rowCount);
+		vMemCopy(newParentRows, hierarchy->parentRows, sizeof(vUI32) * rowCount);
+		vMemCopy(newDirty, hierarchy->dirty, sizeof(vBYTE) * rowCount);
+		vFree(hierarchy->objects);
+		vFree(hierarchy->parentRows);
+		vFree(hierarchy->dirty);
+	}
+
+	hierarchy->objects	   = newObjects;
+	hierarchy->parentRows  = newParentRows;
+	hierarchy->dirty	   = newDirty;
+	hierarchy->rowCapacity = newCapacity;
+}
+
+static void vhHierarchyReserveGather(vPHierarchy hierarchy, vUI32 rows)
+{
+	if (rows <= hierarchy->gatherCapacity) return;
+
+	/* gather stores are scratch, contents need not survive */
+	vUI32 newCapacity = max(rows, hierarchy->gatherCapacity << 1);
+	if (hierarchy->gatherRows)
+	{
+		vDestroyTransformSoA(&hierarchy->gatherParents);
+		vDestroyTransformSoA(&hierarchy->gatherLocals);
+		vDestroyTransformSoA(&hierarchy->gatherWorlds);
+		vFree(hierarchy->gatherRows);
+	}
+
+	vCreateTransformSoA(&hierarchy->gatherParents, newCapacity);
+	vCreateTransformSoA(&hierarchy->gatherLocals, newCapacity);
+	vCreateTransformSoA(&hierarchy->gatherWorlds, newCapacity);
+	hierarchy->gatherRows	  = vAllocZeroed(sizeof(vUI32) * newCapacity);
+	hierarchy->gatherCapacity = newCapacity;
+}
+
+static __forceinline void vhHierarchyCopyRow(vPTransformSoA dest, vUI32 destRow,
+	vPTransformSoA source, vUI32 sourceRow)
+{
+	dest->x[destRow]		= source->x[sourceRow];
+	dest->y[destRow]		= source->y[sourceRow];
+	dest->rotation[destRow] = source->rotation[sourceRow];
+	dest->scale[destRow]	= source->scale[sourceRow];
+}
+
+static void vhHierarchyRemoveRow(vPHierarchy hierarchy, vPObject object)
+{
+	/* swap last row into the hole, order is restored on update */
+	vUI32 row  = object->hierarchyRow;
+	vUI32 last = hierarchy->locals.count - 1;
+	if (row != last)
+	{
+		vhHierarchyCopyRow(&hierarchy->locals, row, &hierarchy->locals, last);
+		vhHierarchyCopyRow(&hierarchy->worlds, row, &hierarchy->worlds, last);
+		hierarchy->objects[row] = hierarchy->objects[last];
+		hierarchy->dirty[row]	= hierarchy->dirty[last];
+		hierarchy->objects[row]->hierarchyRow = row;
+	}
+
+	hierarchy->locals.count--;
+	hierarchy->worlds.count--;
+	object->hasHierarchyRow = FALSE;
+	object->hierarchyRow	= 0;
+	hierarchy->orderDirty	= TRUE;
+}
+
+static void vhHierarchySort(vPHierarchy hierarchy)
+{
+	vUI32 rowCount = hierarchy->locals.count;
+
+	/* counting sort by depth keeps parents ahead of children */
+	vUI32 levelCount = 0;
+	for (vUI32 i = 0; i < rowCount; i++)
+		levelCount = max(levelCount, hierarchy->objects[i]->depth + 1);
+
+	if (hierarchy->levelStarts) vFree(hierarchy->levelStarts);
+	hierarchy->levelStarts = vAllocZeroed(sizeof(vUI32) * (levelCount + 1));
+	hierarchy->levelCount  = levelCount;
+	for (vUI32 i = 0; i < rowCount; i++)
+		hierarchy->levelStarts[hierarchy->objects[i]->depth + 1]++;
+	for (vUI32 i = 0; i < levelCount; i++)
+		hierarchy->levelStarts[i + 1] += hierarchy->levelStarts[i];
+
+	vTransformSoA newLocals, newWorlds;
+	vCreateTransformSoA(&newLocals, hierarchy->rowCapacity);
+	vCreateTransformSoA(&newWorlds, hierarchy->rowCapacity);
+	vPObject* newObjects = vAllocZeroed(sizeof(vPObject) * hierarchy->rowCapacity);
+	vPBYTE	  newDirty	 = vAllocZeroed(sizeof(vBYTE) * hierarchy->rowCapacity);
+
+	vPUI32 fill = vAlloc(sizeof(vUI32) * max(1, levelCount));
+	vMemCopy(fill, hierarchy->levelStarts, sizeof(vUI32) * levelCount);
+	for (vUI32 i = 0; i < rowCount; i++)
+	{
+		vPObject object = hierarchy->objects[i];
+		vUI32	 row	= fill[object->depth]++;
+
+		vhHierarchyCopyRow(&newLocals, row, &hierarchy->locals, i);
+		vhHierarchyCopyRow(&newWorlds, row, &hierarchy->worlds, i);
+		newObjects[row]		 = object;
+		newDirty[row]		 = hierarchy->dirty[i];
+		object->hierarchyRow = row;
+	}
+	vFree(fill);
+
+	vDestroyTransformSoA(&hierarchy->locals);
+	vDestroyTransformSoA(&hierarchy->worlds);
+	vFree(hierarchy->objects);
+	vFree(hierarchy->dirty);
+	newLocals.count		 = rowCount;
+	newWorlds.count		 = rowCount;
+	hierarchy->locals	 = newLocals;
+	hierarchy->worlds	 = newWorlds;
+	hierarchy->objects	 = newObjects;
+	hierarchy->dirty	 = newDirty;
+
+	/* nearest ancestor with a row acts as the parent */
+	for (vUI32 i = 0; i < rowCount; i++)
+	{
+		vPObject ancestor = hierarchy->objects[i]->parent;
+		while (ancestor != NULL && ancestor->hasHierarchyRow == FALSE)
+			ancestor = ancestor->parent;
+		hierarchy->parentRows[i] = ancestor ? ancestor->hierarchyRow : HIERARCHY_ROW_NONE;
+	}
+
+	hierarchy->orderDirty = FALSE;
+}
+
+static vUI32 vhHierarchyGatherLevel(vPHierarchy hierarchy, vUI32 start, vUI32 end)
+{
+	/* dirty flags flow down from parents composed earlier */
+	vUI32 gathered = 0;
+	for (vUI32 row = start; row < end; row++)
+	{
+		vUI32 parentRow = hierarchy->parentRows[row];
+		if (parentRow != HIERARCHY_ROW_NONE)
+			hierarchy->dirty[row] |= hierarchy->dirty[parentRow];
+		if (hierarchy->dirty[row] == FALSE) continue;
+
+		if (parentRow == HIERARCHY_ROW_NONE)
+		{
+			hierarchy->gatherParents.x[gathered]		= 0.0f;
+			hierarchy->gatherParents.y[gathered]		= 0.0f;
+			hierarchy->gatherParents.rotation[gathered] = 0.0f;
+			hierarchy->gatherParents.scale[gathered]	= 1.0f;
+		}
+		else
+			vhHierarchyCopyRow(&hierarchy->gatherParents, gathered, &hierarchy->worlds, parentRow);
+
+		vhHierarchyCopyRow(&hierarchy->gatherLocals, gathered, &hierarchy->locals, row);
+		hierarchy->gatherRows[gathered++] = row;
+	}
+	return gathered;
+}
+
+static void vhHierarchyComposeTask(vPWorker worker, vPTR persistentData,
+	vPHierarchyComposeChunk chunk)
+{
+	vPHierarchy hierarchy = chunk->hierarchy;
+	vTransformCompose(&hierarchy->gatherParents, &hierarchy->gatherLocals,
+		&hierarchy->gatherWorlds, chunk->start, chunk->count);
+}
+
+static void vhHierarchyComposeLevel(vPHierarchy hierarchy, vUI32 count,
+	vPWorker* workers, vUI32 workerCount)
+{
+	if (workers == NULL || workerCount == 0 || count < HIERARCHY_PARALLEL_MIN_ROWS)
+	{
+		vTransformCompose(&hierarchy->gatherParents, &hierarchy->gatherLocals,
+			&hierarchy->gatherWorlds, 0, count);
+		return;
+	}
+
+	/* wide levels are split over workers, chunks stay vector sized */
+	vUI32 targetChunks = workerCount * WORKER_ITERATE_CHUNKS_PER_WORKER;
+	vUI32 chunkSize	   = (count + targetChunks - 1) / targetChunks;
+	chunkSize = (chunkSize + TRANSFORM_SOA_ALIGNMENT - 1) & ~(TRANSFORM_SOA_ALIGNMENT - 1);
+	vUI32 chunkCount   = (count + chunkSize - 1) / chunkSize;
+
+	vPHierarchyComposeChunk chunks = vAllocZeroed(sizeof(vHierarchyComposeChunk) * chunkCount);
+	vPTR* inputs = vAllocZeroed(sizeof(vPTR) * chunkCount);
+	for (vUI32 i = 0; i < chunkCount; i++)
+	{
+		chunks[i].hierarchy = hierarchy;
+		chunks[i].start		= i * chunkSize;
+		chunks[i].count		= min(chunkSize, count - chunks[i].start);
+		inputs[i] = chunks + i;
+	}
+
+	/* the tree lock stays held. compose tasks take no locks and	*/
+	/* the dispatching thread runs unclaimed chunks itself, so a	*/
+	/* cycle waiting on the tree only delays its own worker			*/
+	vWorkerDispatchTaskGroup(workers, workerCount, vhHierarchyComposeTask, inputs, chunkCount);
+
+	vFree(inputs);
+	vFree(chunks);
+}
+
+
+/* ========== TREE STRUCTURE					==========	*/
+VAPI vBOOL    vObjectSetParent(vPObject object, vPObject parent)
+{
+	vRWLockExclusive(&_vcore.hierarchyLock); /* SYNC */
+
+	/* an object can't move below itself */
+	for (vPObject ancestor = parent; ancestor != NULL; ancestor = ancestor->parent)
+	{
+		if (ancestor != object) continue;
+
+		vLogWarningFormatted(__func__, "Tried to parent object '%p' to its own descendant.",
+			object);
+		vRWUnlockExclusive(&_vcore.hierarchyLock); /* UNSYNC */
+		return FALSE;
+	}
+
+	vhHierarchyUnlink(object);
+	vhHierarchyLink(object, parent);
+	vhHierarchyRefreshSubtree(&_vcore.hierarchy, object);
+
+	vRWUnlockExclusive(&_vcore.hierarchyLock); /* UNSYNC */
+	return TRUE;
+}
+
+VAPI vPObject vObjectGetParent(vPObject object)
+{
+	vRWLockShared(&_vcore.hierarchyLock);
+	vPObject parent = object->parent;
+	vRWUnlockShared(&_vcore.hierarchyLock);
+	return parent;
+}
+
+VAPI vPObject vObjectGetFirstChild(vPObject object)
+{
+	vRWLockShared(&_vcore.hierarchyLock);
+	vPObject child = object->firstChild;
+	vRWUnlockShared(&_vcore.hierarchyLock);
+	return child;
+}
+
+VAPI vPObject vObjectGetNextSibling(vPObject object)
+{
+	vRWLockShared(&_vcore.hierarchyLock);
+	vPObject sibling = object->nextSibling;
+	vRWUnlockShared(&_vcore.hierarchyLock);
+	return sibling;
+}
+
+VAPI vUI32    vObjectGetDepth(vPObject object)
+{
+	vRWLockShared(&_vcore.hierarchyLock);
+	vUI32 depth = object->depth;
+	vRWUnlockShared(&_vcore.hierarchyLock);
+	return depth;
+}
+
+VAPI void     vDestroyObjectTree(vPObject root)
+{
+	if (vSchedulerInSystem())
+	{
+		vLogError(__func__, "Tried to destroy object tree inside a scheduler system. "
+			"Record the destruction in a command buffer instead.");
+		return;
+	}
+
+	/* same order as vDestroyObject, release lock first */
+	vRWLockExclusive(&_vcore.objectReleaseLock);
+	vObjectGlobalLock(); /* SYNC */
+	vRWLockExclusive(&_vcore.hierarchyLock);
+
+	/* collect in pre-order, destroy in reverse so leaves go first */
+	vUI32 count = 0;
+	for (vPObject node = root; node != NULL; node = vhHierarchyNextInSubtree(root, node))
+		count++;
+
+	vPObject* nodes = vAlloc(sizeof(vPObject) * count);
+	vUI32 index = 0;
+	for (vPObject node = root; node != NULL; node = vhHierarchyNextInSubtree(root, node))
+		nodes[index++] = node;
+
+	while (index > 0) vDestroyObject(nodes[--index]);
+	vFree(nodes);
+
+	vRWUnlockExclusive(&_vcore.hierarchyLock);
+	vObjectGlobalUnlock(); /* UNSYNC */
+	vRWUnlockExclusive(&_vcore.objectReleaseLock);
+}
+
+
+/* ========== TRANSFORMS						==========	*/
+VAPI void       vObjectSetLocalTransform(vPObject object, vTransform local)
+{
+	vRWLockExclusive(&_vcore.hierarchyLock); /* SYNC */
+	vPHierarchy hierarchy = &_vcore.hierarchy;
+
+	if (object->hasHierarchyRow == FALSE)
+	{
+		/* new rows join at the end until the next update sorts them */
+		vhHierarchyReserveRows(hierarchy, hierarchy->locals.count + 1);
+		vUI32 row = vTransformSoAPush(&hierarchy->locals, local);
+		vTransformSoAPush(&hierarchy->worlds, local);
+		hierarchy->objects[row] = object;
+		object->hasHierarchyRow = TRUE;
+		object->hierarchyRow	= row;
+
+		/* descendants now compose through this row */
+		vhHierarchyRefreshSubtree(hierarchy, object);
+	}
+	else
+	{
+		vUI32 row = object->hierarchyRow;
+		hierarchy->locals.x[row]		= local.position.x;
+		hierarchy->locals.y[row]		= local.position.y;
+		hierarchy->locals.rotation[row] = local.rotation;
+		hierarchy->locals.scale[row]	= local.scale;
+		hierarchy->dirty[row] = TRUE;
+	}
+
+	vRWUnlockExclusive(&_vcore.hierarchyLock); /* UNSYNC */
+}
+
+VAPI vTransform vObjectGetLocalTransform(vPObject object)
+{
+	vRWLockShared(&_vcore.hierarchyLock);
+	vTransform local = object->hasHierarchyRow ?
+		vTransformSoAGet(&_vcore.hierarchy.locals, object->hierarchyRow) :
+		vCreateTransformF(0.0f, 0.0f, 0.0f, 1.0f);
+	vRWUnlockShared(&_vcore.hierarchyLock);
+	return local;
+}
+
+VAPI vTransform vObjectGetWorldTransform(vPObject object)
+{
+	vRWLockShared(&_vcore.hierarchyLock);
+
+	/* objects without a row sit at their nearest ancestor's */
+	vPObject holder = object;
+	while (holder != NULL && holder->hasHierarchyRow == FALSE) holder = holder->parent;
+	vTransform world = holder ?
+		vTransformSoAGet(&_vcore.hierarchy.worlds, holder->hierarchyRow) :
+		vCreateTransformF(0.0f, 0.0f, 0.0f, 1.0f);
+
+	vRWUnlockShared(&_vcore.hierarchyLock);
+	return world;
+}
+
+VAPI vUI32      vHierarchyUpdate(vPWorker* workers, vUI32 workerCount)
+{
+	vRWLockExclusive(&_vcore.hierarchyLock); /* SYNC */
+	vPHierarchy hierarchy = &_vcore.hierarchy;
+
+	if (hierarchy->orderDirty) vhHierarchySort(hierarchy);
+
+	/* one pass per depth level, parents are always done first */
+	vUI32 updated = 0;
+	for (vUI32 level = 0; level < hierarchy->levelCount; level++)
+	{
+		vUI32 start = hierarchy->levelStarts[level];
+		vUI32 end	= hierarchy->levelStarts[level + 1];
+		if (start == end) continue;
+
+		vhHierarchyReserveGather(hierarchy, end - start);
+		vUI32 gathered = vhHierarchyGatherLevel(hierarchy, start, end);
+		if (gathered == 0) continue;
+
+		vhHierarchyComposeLevel(hierarchy, gathered, workers, workerCount);
+		for (vUI32 i = 0; i < gathered; i++)
+			vhHierarchyCopyRow(&hierarchy->worlds, hierarchy->gatherRows[i],
+				&hierarchy->gatherWorlds, i);
+		updated += gathered;
+	}
+
+	if (hierarchy->dirty) vZeroMemory(hierarchy->dirty, hierarchy->locals.count);
+
+	vRWUnlockExclusive(&_vcore.hierarchyLock); /* UNSYNC */
+	return updated;
+}
+
+
+/* ========== OBJECT NOTIFICATION				==========	*/
+VAPI void vHierarchyObjectCreated(vPObject object)
+{
+	vRWLockExclusive(&_vcore.hierarchyLock);
+	vhHierarchyLink(object, object->parent);
+	object->depth = object->parent ? object->parent->depth + 1 : 0;
+	vRWUnlockExclusive(&_vcore.hierarchyLock);
+}
+
+VAPI void vHierarchyObjectDestroyed(vPObject object)
+{
+	vRWLockExclusive(&_vcore.hierarchyLock); /* SYNC */
+	vPHierarchy hierarchy = &_vcore.hierarchy;
+
+	/* children of a destroyed object become roots */
+	vPObject child = object->firstChild;
+	while (child != NULL)
+	{
+		vPObject next = child->nextSibling;
+		child->parent	   = NULL;
+		child->prevSibling = NULL;
+		child->nextSibling = NULL;
+		vhHierarchyRefreshSubtree(hierarchy, child);
+		child = next;
+	}
+	object->firstChild = NULL;
+
+	vhHierarchyUnlink(object);
+	if (object->hasHierarchyRow) vhHierarchyRemoveRow(hierarchy, object);
+
+	vRWUnlockExclusive(&_vcore.hierarchyLock); /* UNSYNC */
+}
@@ -0,0 +1,42 @@
+
+/* ========== <vhierarchy.h>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Object trees and depth ordered world transforms			*/
+
+#ifndef _VCORE_HIERARCHY_INCLUDE_
+#define _VCORE_HIERARCHY_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+
+
+/* ========== USAGE								==========	*/
+/* objects join the transform pass once given a local		*/
+/* transform. rows are kept in depth order so one linear	*/
+/* pass per level composes parents before children. only	*/
+/* rows marked dirty and their descendants are recomputed.	*/
+/* an ancestor without a local transform counts as identity.	*/
+/* world transforms read back as of the last update			*/
+
+
+/* ========== TREE STRUCTURE					==========	*/
+VAPI vBOOL    vObjectSetParent(vPObject object, vPObject parent);
+VAPI vPObject vObjectGetParent(vPObject object);
+VAPI vPObject vObjectGetFirstChild(vPObject object);
+VAPI vPObject vObjectGetNextSibling(vPObject object);
+VAPI vUI32    vObjectGetDepth(vPObject object);
+VAPI void     vDestroyObjectTree(vPObject root);
+
+
+/* ========== TRANSFORMS						==========	*/
+VAPI void       vObjectSetLocalTransform(vPObject object, vTransform local);
+VAPI vTransform vObjectGetLocalTransform(vPObject object);
+VAPI vTransform vObjectGetWorldTransform(vPObject object);
+VAPI vUI32      vHierarchyUpdate(vPWorker* workers, vUI32 workerCount);
+
+
+/* ========== OBJECT NOTIFICATION				==========	*/
+VAPI void vHierarchyObjectCreated(vPObject object);
+VAPI void vHierarchyObjectDestroyed(vPObject object);
+
+#endif
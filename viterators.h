@@ -0,0 +1,212 @@
+
+/* ========== <viterators.h>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Inline cursor iterators for buffering systems			*/
+
+#ifndef _VCORE_ITERATORS_INCLUDE_
+#define _VCORE_ITERATORS_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+#include <intrin.h>
+
+
+/* ========== USAGE								==========	*/
+/* not part of vcore.h, include this header directly.		*/
+/* iterators take no locks. hold the container lock (shared	*/
+/* is enough) for the whole loop, for example:				*/
+/*															*/
+/*	vBufferIterator it;										*/
+/*	for (vBufferIteratorBegin(buffer, &it);					*/
+/*		vBufferIteratorEnd(&it) == FALSE;					*/
+/*		vBufferIteratorNext(&it))							*/
+/*		sum += ((vPMyType)it.element)->value;				*/
+/*															*/
+/* run variants yield contiguous live elements, runLength	*/
+/* at a time, which suits vectorized loop bodies			*/
+
+
+/* ========== HELPER							==========	*/
+static __forceinline vBOOL vhIteratorFindSet(vPUI64 field, vUI64 limit, vUI64 from,
+	vPUI64 indexOut)
+{
+	/* first set bit at or after from */
+	vUI64 wordCount = (limit + 0x3F) >> 0x06;
+	vUI64 chunk		= from >> 0x06;
+	if (chunk >= wordCount) return FALSE;
+
+	vUI64 word = field[chunk] & (~0ULL << (from & 0x3F));
+	while (word == 0)
+	{
+		if (++chunk >= wordCount) return FALSE;
+		word = field[chunk];
+	}
+
+	unsigned long bit;
+	_BitScanForward64(&bit, word);
+	*indexOut = (chunk << 0x06) + bit;
+	return (*indexOut < limit);
+}
+
+static __forceinline vUI64 vhIteratorRunLength(vPUI64 field, vUI64 limit, vUI64 start)
+{
+	/* first clear bit after start, runs may cross words */
+	vUI64 wordCount = (limit + 0x3F) >> 0x06;
+	vUI64 chunk		= start >> 0x06;
+
+	vUI64 clear = ~field[chunk] & (~0ULL << (start & 0x3F));
+	while (clear == 0)
+	{
+		if (++chunk >= wordCount) return limit - start;
+		clear = ~field[chunk];
+	}
+
+	unsigned long bit;
+	_BitScanForward64(&bit, clear);
+	return min(limit, (chunk << 0x06) + bit) - start;
+}
+
+static __forceinline void vhBufferIteratorSeek(vPBufferIterator it, vUI64 from,
+	vBOOL run)
+{
+	/* dense buffers are one contiguous run */
+	if (it->field == NULL)
+	{
+		it->ended = (from >= it->limit);
+		it->index = from;
+		it->runLength = it->ended ? 0 : (run ? it->limit - from : 1);
+	}
+	else
+	{
+		it->ended = (vhIteratorFindSet(it->field, it->limit, from, &it->index) == FALSE);
+		it->runLength = it->ended ? 0 :
+			(run ? vhIteratorRunLength(it->field, it->limit, it->index) : 1);
+	}
+
+	it->element = it->ended ? NULL : it->data + (it->index * it->elementSizeBytes);
+}
+
+static __forceinline void vhDBufferIteratorSeek(vPDBufferIterator it, vUI64 from,
+	vBOOL run)
+{
+	vUI64 limit = it->buffer->nodeSize;
+
+	/* move through nodes until one has a live element */
+	while (it->node != NULL)
+	{
+		if (it->node->elementCount != 0 &&
+			vhIteratorFindSet(it->node->useField, limit, from, &it->index))
+		{
+			it->runLength = run ?
+				vhIteratorRunLength(it->node->useField, limit, it->index) : 1;
+			it->element = (vPBYTE)it->node->block +
+				(it->index * it->buffer->elementSizeBytes);
+			it->ended = FALSE;
+			return;
+		}
+
+		it->node = it->node->next;
+		from = 0;
+	}
+
+	it->index	  = 0;
+	it->element	  = NULL;
+	it->runLength = 0;
+	it->ended	  = TRUE;
+}
+
+
+/* ========== vBUFFER ITERATION					==========	*/
+static __forceinline void vBufferIteratorInit(vHNDL buffer, vPBufferIterator it)
+{
+	/* library state is reached through vGetInternals() since	*/
+	/* this header is compiled into client translation units	*/
+	vPBuffer buff = vGetInternals()->buffers + buffer;
+
+	it->buffer			 = buffer;
+	it->data			 = buff->data;
+	it->elementSizeBytes = buff->elementSizeBytes;
+	if (buff->flags & BUFFER_FLAG_DENSE)
+	{
+		it->field = NULL;
+		it->limit = buff->elementsUsed;
+	}
+	else
+	{
+		it->field = (buff->liveField != NULL) ? buff->liveField : buff->useField;
+		it->limit = buff->capacity;
+	}
+}
+
+static __forceinline vBOOL vBufferIteratorBegin(vHNDL buffer, vPBufferIterator it)
+{
+	vBufferIteratorInit(buffer, it);
+	vhBufferIteratorSeek(it, 0, FALSE);
+	return !it->ended;
+}
+
+static __forceinline vBOOL vBufferIteratorNext(vPBufferIterator it)
+{
+	vhBufferIteratorSeek(it, it->index + 1, FALSE);
+	return !it->ended;
+}
+
+static __forceinline vBOOL vBufferIteratorEnd(vPBufferIterator it)
+{
+	return it->ended;
+}
+
+static __forceinline vBOOL vBufferIteratorBeginRun(vHNDL buffer, vPBufferIterator it)
+{
+	vBufferIteratorInit(buffer, it);
+	vhBufferIteratorSeek(it, 0, TRUE);
+	return !it->ended;
+}
+
+static __forceinline vBOOL vBufferIteratorNextRun(vPBufferIterator it)
+{
+	vhBufferIteratorSeek(it, it->index + it->runLength, TRUE);
+	return !it->ended;
+}
+
+
+/* ========== vDBUFFER ITERATION				==========	*/
+static __forceinline void vDBufferIteratorInit(vHNDL dBuffer, vPDBufferIterator it)
+{
+	it->dBuffer = dBuffer;
+	it->buffer	= vGetInternals()->dbuffers + dBuffer;
+	it->node	= it->buffer->head;
+}
+
+static __forceinline vBOOL vDBufferIteratorBegin(vHNDL dBuffer, vPDBufferIterator it)
+{
+	vDBufferIteratorInit(dBuffer, it);
+	vhDBufferIteratorSeek(it, 0, FALSE);
+	return !it->ended;
+}
+
+static __forceinline vBOOL vDBufferIteratorNext(vPDBufferIterator it)
+{
+	vhDBufferIteratorSeek(it, it->index + 1, FALSE);
+	return !it->ended;
+}
+
+static __forceinline vBOOL vDBufferIteratorEnd(vPDBufferIterator it)
+{
+	return it->ended;
+}
+
+static __forceinline vBOOL vDBufferIteratorBeginRun(vHNDL dBuffer, vPDBufferIterator it)
+{
+	vDBufferIteratorInit(dBuffer, it);
+	vhDBufferIteratorSeek(it, 0, TRUE);
+	return !it->ended;
+}
+
+static __forceinline vBOOL vDBufferIteratorNextRun(vPDBufferIterator it)
+{
+	vhDBufferIteratorSeek(it, it->index + it->runLength, TRUE);
+	return !it->ended;
+}
+
+#endif
@@ -0,0 +1,455 @@
+
+/* ========== <vlbuffers.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vlbuffers.h"
+#include <intrin.h>
+
+
+/* ========== HELPER							==========	*/
+static __forceinline vUI32 vhFindFreeLBufferIndex(void)
+{
+	/* loop and check each's in use flag. on free, return	*/
+	for (vUI32 i = 0; i < MAX_LBUFFERS; i++)
+	{
+		if (_vcore.lbuffers[i].inUse) continue;
+		return i;
+	}
+
+	/* on reach here, all buffers are used. log and exit	*/
+	vLogError(__func__, "Trying to create new large buffer, but "
+		"maximum amount of large buffers have been created. "
+		"Error is unrecoverable and process will be terminated.");
+	vCoreFatalError(__func__, "Could not create more large buffers.");
+}
+
+static __forceinline void vhMapIndexToUseField(vUI64 index, vPUI64 chunk, vPUI64 bit)
+{
+	*chunk	= (index >> 0x06    );
+	*bit	= (index &  0b111111);
+}
+
+static __forceinline vUI64 vhMapUseFieldToIndex(vUI64 chunk, vUI64 bit)
+{
+	return (chunk << 0x06) + bit;
+}
+
+static __forceinline vPLBufferSegment vhGetSegment(vPLBuffer buffer, vUI64 segment)
+{
+	return (vPLBufferSegment)(buffer->base + (segment * buffer->segmentStrideBytes));
+}
+
+static __forceinline vPBYTE vhGetSegmentElement(vPLBuffer buffer, vUI64 segment,
+	vUI64 slot)
+{
+	return (vPBYTE)vhGetSegment(buffer, segment) + buffer->segmentDataOffset +
+		(slot * buffer->elementSizeBytes);
+}
+
+static __forceinline vBOOL vhMapPtrToSegmentSlot(vPLBuffer buffer, vPTR ptr,
+	vPUI64 segment, vPUI64 slot)
+{
+	vUI64 offset = (vPBYTE)ptr - buffer->base;
+	*segment = offset / buffer->segmentStrideBytes;
+
+	vUI64 segmentOffset = offset - (*segment * buffer->segmentStrideBytes);
+	if (segmentOffset < buffer->segmentDataOffset) return FALSE;
+
+	*slot = (segmentOffset - buffer->segmentDataOffset) / buffer->elementSizeBytes;
+	return (*segment < buffer->segmentsCommitted && *slot < LBUFFER_SEGMENT_SIZE);
+}
+
+static __forceinline vBOOL vhCommitSegment(vPLBuffer buffer)
+{
+	if (buffer->segmentsCommitted >= buffer->segmentsReserved) return FALSE;
+
+	/* committed pages are zeroed by the system */
+	vPTR segment = VirtualAlloc(vhGetSegment(buffer, buffer->segmentsCommitted),
+		buffer->segmentStrideBytes, MEM_COMMIT, PAGE_READWRITE);
+	if (segment == NULL)
+	{
+		vLogErrorFormatted(__func__, "Could not commit segment for large buffer '%s'.",
+			buffer->name);
+		return FALSE;
+	}
+
+	buffer->segmentsCommitted++;
+	buffer->capacity += LBUFFER_SEGMENT_SIZE;
+	_vcore.memoryUseage += buffer->segmentStrideBytes;
+
+	return TRUE;
+}
+
+static __forceinline vUI64 vhClaimSegmentSlot(vPLBufferSegment segment)
+{
+	if (segment->elementCount >= LBUFFER_SEGMENT_SIZE) return ~0ULL;
+
+	for (vUI64 chunk = 0; chunk < (LBUFFER_SEGMENT_SIZE >> 0x06); chunk++)
+	{
+		vUI64 freeMask = ~segment->useField[chunk];
+		if (freeMask == 0) continue;
+
+		unsigned long bit;
+		_BitScanForward64(&bit, freeMask);
+
+		_bittestandset64(segment->useField + chunk, bit);
+		segment->elementCount++;
+
+		return vhMapUseFieldToIndex(chunk, bit);
+	}
+
+	return ~0ULL;
+}
+
+static __forceinline vBOOL vhRemoveSegmentSlot(vHNDL lBuffer, vPLBuffer buffer,
+	vUI64 segmentIndex, vUI64 slot)
+{
+	vPLBufferSegment segment = vhGetSegment(buffer, segmentIndex);
+
+	vUI64 chunk, bit;
+	vhMapIndexToUseField(slot, &chunk, &bit);
+	if (_bittest64(segment->useField + chunk, bit) == FALSE)
+	{
+		vLogWarning(__func__, "Tried to remove element that doesn't exist.");
+		return FALSE;
+	}
+
+	/* call destruction function (if exists) */
+	if (buffer->destroyFunc)
+		buffer->destroyFunc(lBuffer, (segmentIndex * LBUFFER_SEGMENT_SIZE) + slot,
+			vhGetSegmentElement(buffer, segmentIndex, slot));
+
+	_bittestandreset64(segment->useField + chunk, bit);
+	segment->elementCount--;
+	buffer->elementsUsed--;
+
+	/* freed segment is guaranteed to have a free slot */
+	buffer->searchHint = segmentIndex;
+
+	return TRUE;
+}
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vHNDL vCreateLBuffer(const char* bufferName, vUI32 elementSize,
+	vUI64 maxCapacity, vPFLBUFFERINITIALIZEELEMENT initializeFunc,
+	vPFLBUFFERDESTROYELEMENT destroyFunc)
+{
+	/* SYNC		*/ vCoreLock();
+
+	/* find new buffer */
+	vUI32 bufferIndex = vhFindFreeLBufferIndex();
+	vPLBuffer buffer = _vcore.lbuffers + bufferIndex;
+	vZeroMemory(buffer, sizeof(vLBuffer));
+
+	/* initialize name */
+	if (bufferName == NULL)
+	{
+		vLogWarning(__func__, "Created large buffer with no name.");
+	}
+	else
+	{
+		vMemCopy(buffer->name, bufferName, min(BUFF_SMALL - 1, strlen(bufferName)));
+	}
+
+	/* segment layout is header, then cache line aligned data */
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	vUI64 pageSize = systemInfo.dwPageSize;
+
+	buffer->elementSizeBytes   = max(1, elementSize);
+	buffer->segmentDataOffset  = (sizeof(vLBufferSegment) + 0x3F) & ~0x3FULL;
+	buffer->segmentStrideBytes = buffer->segmentDataOffset +
+		(LBUFFER_SEGMENT_SIZE * (vUI64)buffer->elementSizeBytes);
+	buffer->segmentStrideBytes = (buffer->segmentStrideBytes + pageSize - 1) & ~(pageSize - 1);
+	buffer->segmentsReserved   = max(1, (maxCapacity + LBUFFER_SEGMENT_SIZE - 1) /
+		LBUFFER_SEGMENT_SIZE);
+	buffer->maxCapacity		   = buffer->segmentsReserved * LBUFFER_SEGMENT_SIZE;
+
+	/* reserve the whole range so element pointers never move */
+	buffer->base = VirtualAlloc(NULL, buffer->segmentsReserved * buffer->segmentStrideBytes,
+		MEM_RESERVE, PAGE_NOACCESS);
+	if (buffer->base == NULL)
+	{
+		vLogErrorFormatted(__func__, "Could not reserve %llu elements for large buffer '%s'.",
+			buffer->maxCapacity, buffer->name);
+		vCoreFatalError(__func__, "Could not reserve memory for large buffer.");
+	}
+
+	/* initialize element related data */
+	InitializeCriticalSection(&buffer->rwPermission);
+	vCoreTime(&buffer->timeCreated);
+	buffer->initializeFunc = initializeFunc;
+	buffer->destroyFunc	   = destroyFunc;
+	buffer->inUse		   = TRUE;
+
+	/* log buffer creation */
+	vLogInfoFormatted(__func__,
+		"Large buffer '%s' created with "
+		"element size %d and max capacity %llu.",
+		buffer->name, buffer->elementSizeBytes, buffer->maxCapacity);
+
+	/* UNSYNC	*/ vCoreUnlock();
+
+	return bufferIndex;
+}
+
+VAPI vBOOL vDestroyLBuffer(vHNDL lBuffer)
+{
+	/* SYNC		*/ vCoreLock();
+
+	vPLBuffer buffer = _vcore.lbuffers + lBuffer;
+	if (buffer->inUse == FALSE)
+	{
+		vLogWarning(__func__, "Tried to destroy large buffer which does not exist.");
+		vCoreUnlock();
+		return FALSE;
+	}
+
+	/* wait for buffer to finish */
+	vLBufferLock(lBuffer);
+
+	/* destroy all elements */
+	for (vUI64 i = 0; i < buffer->segmentsCommitted; i++)
+	{
+		vPLBufferSegment segment = vhGetSegment(buffer, i);
+		for (vUI64 chunk = 0; chunk < (LBUFFER_SEGMENT_SIZE >> 0x06); chunk++)
+		{
+			vUI64 word = segment->useField[chunk];
+			while (word != 0)
+			{
+				unsigned long bit;
+				_BitScanForward64(&bit, word);
+				word &= word - 1;
+
+				vhRemoveSegmentSlot(lBuffer, buffer, i, vhMapUseFieldToIndex(chunk, bit));
+			}
+		}
+	}
+
+	/* release the whole reserved range */
+	_vcore.memoryUseage -= buffer->segmentsCommitted * buffer->segmentStrideBytes;
+	VirtualFree(buffer->base, 0, MEM_RELEASE);
+
+	/* delete buffer sync object */
+	DeleteCriticalSection(&buffer->rwPermission);
+	buffer->inUse = FALSE;
+
+	/* log buffer deletion */
+	vLogInfoFormatted(__func__, "Destroyed large buffer '%s'.",
+		buffer->name);
+
+	/* UNSYNC	*/ vCoreUnlock();
+
+	return TRUE;
+}
+
+
+/* ========== SYNCHRONIZATION					==========	*/
+VAPI void vLBufferLock(vHNDL lBuffer)
+{
+	EnterCriticalSection(&_vcore.lbuffers[lBuffer].rwPermission);
+}
+
+VAPI void vLBufferUnlock(vHNDL lBuffer)
+{
+	LeaveCriticalSection(&_vcore.lbuffers[lBuffer].rwPermission);
+}
+
+
+/* ========== ELEMENT MANIPULATION				==========	*/
+VAPI vPTR  vLBufferAdd(vHNDL lBuffer, vPTR input, vPUI64 indexOut)
+{
+	vPLBuffer buffer = _vcore.lbuffers + lBuffer;
+
+	/* SYNC		*/ vLBufferLock(lBuffer);
+
+	/* search committed segments, starting at the hint */
+	vUI64 segmentIndex = ~0ULL;
+	vUI64 slot		   = ~0ULL;
+	for (vUI64 i = 0; i < buffer->segmentsCommitted; i++)
+	{
+		vUI64 current = buffer->searchHint + i;
+		if (current >= buffer->segmentsCommitted) current -= buffer->segmentsCommitted;
+
+		slot = vhClaimSegmentSlot(vhGetSegment(buffer, current));
+		if (slot == ~0ULL) continue;
+
+		segmentIndex = current;
+		break;
+	}
+
+	/* on all segments full, grow by one segment */
+	if (segmentIndex == ~0ULL)
+	{
+		if (vhCommitSegment(buffer) == FALSE)
+		{
+			/* UNSYNC	*/ vLBufferUnlock(lBuffer);
+
+			vLogWarningFormatted(__func__, "Large buffer '%s' is full at %llu elements.",
+				buffer->name, buffer->maxCapacity);
+			return NULL;
+		}
+
+		segmentIndex = buffer->segmentsCommitted - 1;
+		slot = vhClaimSegmentSlot(vhGetSegment(buffer, segmentIndex));
+	}
+
+	buffer->searchHint = segmentIndex;
+	buffer->elementsUsed++;
+
+	/* get ptr and zero memory */
+	vUI64 index = (segmentIndex * LBUFFER_SEGMENT_SIZE) + slot;
+	vPTR elemPtr = vhGetSegmentElement(buffer, segmentIndex, slot);
+	vZeroMemory(elemPtr, buffer->elementSizeBytes);
+
+	/* call initialization callback if it exists */
+	if (buffer->initializeFunc)
+		buffer->initializeFunc(lBuffer, index, elemPtr, input);
+
+	/* UNSYNC	*/ vLBufferUnlock(lBuffer);
+
+	if (indexOut != NULL) *indexOut = index;
+	return elemPtr;
+}
+
+VAPI vBOOL vLBufferRemove(vHNDL lBuffer, vPTR element)
+{
+	vPLBuffer buffer = _vcore.lbuffers + lBuffer;
+
+	/* SYNC		*/ vLBufferLock(lBuffer);
+
+	vBOOL result = FALSE;
+	vUI64 segmentIndex, slot;
+	if (vhMapPtrToSegmentSlot(buffer, element, &segmentIndex, &slot) == FALSE)
+	{
+		vLogWarning(__func__, "Tried to remove element that is not in large buffer.");
+	}
+	else
+	{
+		result = vhRemoveSegmentSlot(lBuffer, buffer, segmentIndex, slot);
+	}
+
+	/* UNSYNC	*/ vLBufferUnlock(lBuffer);
+
+	return result;
+}
+
+VAPI vBOOL vLBufferRemoveIndex(vHNDL lBuffer, vUI64 index)
+{
+	vPLBuffer buffer = _vcore.lbuffers + lBuffer;
+
+	/* SYNC		*/ vLBufferLock(lBuffer);
+
+	vBOOL result = FALSE;
+	if (index >= buffer->capacity)
+	{
+		vLogWarning(__func__, "Tried to remove index outside of large buffer.");
+	}
+	else
+	{
+		result = vhRemoveSegmentSlot(lBuffer, buffer, index / LBUFFER_SEGMENT_SIZE,
+			index % LBUFFER_SEGMENT_SIZE);
+	}
+
+	/* UNSYNC	*/ vLBufferUnlock(lBuffer);
+
+	return result;
+}
+
+VAPI vUI64 vLBufferGetElementIndex(vHNDL lBuffer, vPTR element)
+{
+	vPLBuffer buffer = _vcore.lbuffers + lBuffer;
+
+	vUI64 segmentIndex, slot;
+	if (vhMapPtrToSegmentSlot(buffer, element, &segmentIndex, &slot) == FALSE)
+		return ~0ULL;
+
+	return (segmentIndex * LBUFFER_SEGMENT_SIZE) + slot;
+}
+
+VAPI vPTR  vLBufferGetIndex(vHNDL lBuffer, vUI64 index)
+{
+	vPLBuffer buffer = _vcore.lbuffers + lBuffer;
+
+	if (buffer->inUse == FALSE)
+	{
+		vLogError(__func__, "Tried to get index from large buffer that doesn't exist");
+		return NULL;
+	}
+	if (vLBufferIndexUsed(lBuffer, index) == FALSE)
+	{
+		vLogError(__func__, "Tried to get index that was unused.");
+		return NULL;
+	}
+
+	return vhGetSegmentElement(buffer, index / LBUFFER_SEGMENT_SIZE,
+		index % LBUFFER_SEGMENT_SIZE);
+}
+
+VAPI void  vLBufferIterate(vHNDL lBuffer, vPFLBUFFERITERATEFUNC function, vPTR input)
+{
+	if (function == NULL)
+	{
+		vLogWarning(__func__, "Tried to iterate over large buffer with NULL function.");
+		return;
+	}
+
+	vPLBuffer buffer = _vcore.lbuffers + lBuffer;
+
+	/* SYNC		*/ vLBufferLock(lBuffer);
+
+	/* walk each segment's data densely, skipping empty words */
+	for (vUI64 i = 0; i < buffer->segmentsCommitted; i++)
+	{
+		vPLBufferSegment segment = vhGetSegment(buffer, i);
+		if (segment->elementCount == 0) continue;
+
+		for (vUI64 chunk = 0; chunk < (LBUFFER_SEGMENT_SIZE >> 0x06); chunk++)
+		{
+			vUI64 word = segment->useField[chunk];
+			while (word != 0)
+			{
+				unsigned long bit;
+				_BitScanForward64(&bit, word);
+				word &= word - 1;
+
+				vUI64 slot = vhMapUseFieldToIndex(chunk, bit);
+				function(lBuffer, (i * LBUFFER_SEGMENT_SIZE) + slot,
+					vhGetSegmentElement(buffer, i, slot), input);
+			}
+		}
+	}
+
+	/* UNSYNC	*/ vLBufferUnlock(lBuffer);
+}
+
+
+/* ========== BUFFER INFORMATION				==========	*/
+VAPI vUI64 vLBufferGetElementCount(vHNDL lBuffer)
+{
+	return _vcore.lbuffers[lBuffer].elementsUsed;
+}
+
+VAPI vUI64 vLBufferGetCapacity(vHNDL lBuffer)
+{
+	return _vcore.lbuffers[lBuffer].capacity;
+}
+
+VAPI vBOOL vLBufferExists(vHNDL lBuffer)
+{
+	if (lBuffer >= MAX_LBUFFERS) return FALSE;
+	return _vcore.lbuffers[lBuffer].inUse;
+}
+
+VAPI vBOOL vLBufferIndexUsed(vHNDL lBuffer, vUI64 index)
+{
+	vPLBuffer buffer = _vcore.lbuffers + lBuffer;
+	if (index >= buffer->capacity) return FALSE;
+
+	vUI64 chunk, bit;
+	vhMapIndexToUseField(index % LBUFFER_SEGMENT_SIZE, &chunk, &bit);
+	return _bittest64(vhGetSegment(buffer, index / LBUFFER_SEGMENT_SIZE)->useField + chunk, bit);
+}
@@ -0,0 +1,40 @@
+
+/* ========== <vlbuffers.h>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Growable fixed-sized buffering system with 64-bit indices	*/
+
+#ifndef _VCORE_LBUFFERS_INCLUDE_
+#define _VCORE_LBUFFERS_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vHNDL vCreateLBuffer(const char* bufferName, vUI32 elementSize,
+	vUI64 maxCapacity, vPFLBUFFERINITIALIZEELEMENT initializeFunc,
+	vPFLBUFFERDESTROYELEMENT destroyFunc);
+VAPI vBOOL vDestroyLBuffer(vHNDL lBuffer);
+
+
+/* ========== SYNCHRONIZATION					==========	*/
+VAPI void vLBufferLock(vHNDL lBuffer);
+VAPI void vLBufferUnlock(vHNDL lBuffer);
+
+
+/* ========== ELEMENT MANIPULATION				==========	*/
+VAPI vPTR  vLBufferAdd(vHNDL lBuffer, vPTR input, vPUI64 indexOut);
+VAPI vBOOL vLBufferRemove(vHNDL lBuffer, vPTR element);
+VAPI vBOOL vLBufferRemoveIndex(vHNDL lBuffer, vUI64 index);
+VAPI vUI64 vLBufferGetElementIndex(vHNDL lBuffer, vPTR element);
+VAPI vPTR  vLBufferGetIndex(vHNDL lBuffer, vUI64 index);
+VAPI void  vLBufferIterate(vHNDL lBuffer, vPFLBUFFERITERATEFUNC function, vPTR input);
+
+
+/* ========== BUFFER INFORMATION				==========	*/
+VAPI vUI64 vLBufferGetElementCount(vHNDL lBuffer);
+VAPI vUI64 vLBufferGetCapacity(vHNDL lBuffer);
+VAPI vBOOL vLBufferExists(vHNDL lBuffer);
+VAPI vBOOL vLBufferIndexUsed(vHNDL lBuffer, vUI64 index);
+
+#endif
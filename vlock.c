@@ -22,6 +22,33 @@ static __forceinline vUI32 vhFindFreeLockIndex(void)
 		"Error is unrecoverable.");
 }
 
+static void NTAPI vhRWLockThreadExit(vPTR table)
+{
+	if (table) vFree(table);
+}
+
+static __forceinline vPRWLockThreadTable vhGetRWLockThreadTable(vBOOL create)
+{
+	vPRWLockThreadTable table = FlsGetValue(_vcore.rwLockFls);
+	if (table == NULL && create)
+	{
+		table = vAllocZeroed(sizeof(vRWLockThreadTable));
+		FlsSetValue(_vcore.rwLockFls, table);
+	}
+	return table;
+}
+
+static __forceinline vPRWLockSharedHold vhFindSharedHold(vPRWLockThreadTable table,
+	vPRWLock rwLock)
+{
+	if (table == NULL) return NULL;
+	for (vUI32 i = 0; i < table->count; i++)
+	{
+		if (table->holds[i].lock == rwLock) return table->holds + i;
+	}
+	return NULL;
+}
+
 
 /* ========== CREATION AND DESTRUCTION			==========	*/
 VAPI vHNDL vCreateLock(void)
@@ -71,4 +98,117 @@ VAPI void vLock(vHNDL lock)
 VAPI void vUnlock(vHNDL lock)
 {
 	LeaveCriticalSection(&_vcore.locks[lock]);
-}
\ No newline at end of file
+}
+
+
+/* ========== READER/WRITER LOCKS				==========	*/
+VAPI void vRWLockInitialize(vPRWLock rwLock)
+{
+	/* first call comes from vCoreInitialize before any other	*/
+	/* thread can touch a lock, so setup here is never raced	*/
+	if (_vcore.rwLockFlsReady == FALSE)
+	{
+		_vcore.rwLockFls = FlsAlloc(vhRWLockThreadExit);
+		if (_vcore.rwLockFls == FLS_OUT_OF_INDEXES)
+		{
+			vLogError(__func__, "Could not allocate reader/writer lock thread storage.");
+			vCoreFatalError(__func__, "Could not allocate reader/writer lock thread storage.");
+		}
+		_vcore.rwLockFlsReady = TRUE;
+	}
+
+	InitializeSRWLock(&rwLock->lock);
+	rwLock->exclusiveOwner = 0;
+	rwLock->exclusiveDepth = 0;
+}
+
+VAPI void vRWLockExclusive(vPRWLock rwLock)
+{
+	/* owner can only ever read its own id here */
+	DWORD threadID = GetCurrentThreadId();
+	if (rwLock->exclusiveOwner == threadID)
+	{
+		rwLock->exclusiveDepth++;
+		return;
+	}
+
+	/* upgrading would wait on this thread's own shared hold */
+	if (vhFindSharedHold(vhGetRWLockThreadTable(FALSE), rwLock) != NULL)
+	{
+		vLogError(__func__, "Thread asked for exclusive access to a reader/writer "
+			"lock it holds shared. This would deadlock.");
+		vCoreFatalError(__func__, "Reader/writer lock upgraded from shared to exclusive.");
+	}
+
+	AcquireSRWLockExclusive(&rwLock->lock);
+	rwLock->exclusiveOwner = threadID;
+	rwLock->exclusiveDepth = 1;
+}
+
+VAPI void vRWUnlockExclusive(vPRWLock rwLock)
+{
+	if (--rwLock->exclusiveDepth != 0) return;
+
+	rwLock->exclusiveOwner = 0;
+	ReleaseSRWLockExclusive(&rwLock->lock);
+}
+
+VAPI void vRWLockShared(vPRWLock rwLock)
+{
+	/* exclusive owner already excludes everyone else */
+	if (rwLock->exclusiveOwner == GetCurrentThreadId())
+	{
+		rwLock->exclusiveDepth++;
+		return;
+	}
+
+	/* SRW shared mode isn't reentrant, a nested acquire would	*/
+	/* queue behind any waiting writer. count it instead		*/
+	vPRWLockThreadTable table = vhGetRWLockThreadTable(TRUE);
+	vPRWLockSharedHold hold = vhFindSharedHold(table, rwLock);
+	if (hold != NULL)
+	{
+		hold->depth++;
+		return;
+	}
+
+	if (table->count == RWLOCK_SHARED_HELD_MAX)
+	{
+		vLogError(__func__, "Thread holds too many reader/writer locks shared.");
+		vCoreFatalError(__func__, "Thread holds too many reader/writer locks shared.");
+	}
+
+	AcquireSRWLockShared(&rwLock->lock);
+	table->holds[table->count].lock  = rwLock;
+	table->holds[table->count].depth = 1;
+	table->count++;
+}
+
+VAPI void vRWUnlockShared(vPRWLock rwLock)
+{
+	if (rwLock->exclusiveOwner == GetCurrentThreadId())
+	{
+		vRWUnlockExclusive(rwLock);
+		return;
+	}
+
+	vPRWLockThreadTable table = vhGetRWLockThreadTable(FALSE);
+	vPRWLockSharedHold hold = vhFindSharedHold(table, rwLock);
+	if (hold == NULL)
+	{
+		vLogWarning(__func__, "Tried to release a reader/writer lock this thread "
+			"doesn't hold shared.");
+		return;
+	}
+	if (--hold->depth != 0) return;
+
+	/* last hold, fill the gap with the table's tail */
+	*hold = table->holds[--table->count];
+	ReleaseSRWLockShared(&rwLock->lock);
+}
+
+VAPI vBOOL vRWLockHeldShared(vPRWLock rwLock)
+{
+	/* shared holds nested inside an exclusive one don't count */
+	return vhFindSharedHold(vhGetRWLockThreadTable(FALSE), rwLock) != NULL;
+}
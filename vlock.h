@@ -19,4 +19,16 @@ VAPI void  vDestroyLock(vHNDL lock);
 VAPI void vLock(vHNDL lock);
 VAPI void vUnlock(vHNDL lock);
 
+
+/* ========== READER/WRITER LOCKS				==========	*/
+/* both modes nest on the same thread. shared mode taken by	*/
+/* the exclusive owner nests inside the exclusive hold.		*/
+/* asking for exclusive while holding shared is a fatal error	*/
+VAPI void vRWLockInitialize(vPRWLock rwLock);
+VAPI void vRWLockExclusive(vPRWLock rwLock);
+VAPI void vRWUnlockExclusive(vPRWLock rwLock);
+VAPI void vRWLockShared(vPRWLock rwLock);
+VAPI void vRWUnlockShared(vPRWLock rwLock);
+VAPI vBOOL vRWLockHeldShared(vPRWLock rwLock);
+
 #endif
\ No newline at end of file
@@ -4,6 +4,62 @@
 
 /* ========== INCLUDES							==========	*/
 #include "vobject.h"
+#include <stdio.h>
+#include <intrin.h>
+
+
+/* ========== HELPER							==========	*/
+static __forceinline vPTR vhAcquireComponentAttribute(vPComponentDescriptor desc)
+{
+	/* pooled attributes come zeroed from the dbuffer */
+	if (desc->attributePooled)
+		return vDBufferAdd(desc->attributePool, NULL);
+	return vAllocZeroed(max(4, desc->objectAttributeSize));
+}
+
+static void vhComponentCycleListElementInitFunc(vHNDL dBuffer, vPComponent* element,
+	vPComponent input)
+{
+	*element = input;
+}
+
+static __forceinline vBOOL vhObjectHasComponent(vPObject object, vUI16 component)
+{
+	return _bittest64(object->componentSignature + (component >> 0x06), component & 0x3F);
+}
+
+static __forceinline vBOOL vhArchetypeChangeRefused(const char* function, vPObject object)
+{
+	/* moving rows needs the archetype lock exclusive. a thread	*/
+	/* holding it shared, like a component cycle, would wait on	*/
+	/* itself, so the change is refused instead					*/
+	if (_vcore.objectStorageMode != OBJECT_STORAGE_ARCHETYPE) return FALSE;
+	if (vArchetypeLockHeldShared() == FALSE) return FALSE;
+
+	vLogErrorFormatted(function, "Tried to change object '%p' while holding the "
+		"archetype lock shared. Record the change in a command buffer instead.", object);
+	return TRUE;
+}
+
+static __forceinline vBOOL vhObjectReleaseRefused(const char* function, vPObject object)
+{
+	/* releases wait for the running frame, which can't end	*/
+	/* while one of its own systems is waiting				*/
+	if (vSchedulerInSystem() == FALSE) return FALSE;
+
+	vLogErrorFormatted(function, "Tried to release from object '%p' inside a "
+		"scheduler system. Record the change in a command buffer instead.", object);
+	return TRUE;
+}
+
+static __forceinline void vhReleaseComponentAttribute(vPComponentDescriptor desc,
+	vPTR attribute)
+{
+	if (desc->attributePooled)
+		vDBufferRemove(desc->attributePool, attribute);
+	else
+		vFree(attribute);
+}
 
 
 /* ========== CREATION AND DESTRUCTION			==========	*/
@@ -41,6 +97,10 @@ VAPI vPObject   vCreateObject(vPObject parent)
 	vPObject object = vDBufferAdd(_vcore.objects, NULL);
 	InitializeCriticalSection(&object->lock);
 	object->parent = parent;
+	vHierarchyObjectCreated(object);
+
+	/* empty objects already match exclude only queries */
+	vQueryObjectChanged(object);
 
 	vDBufferUnlock(_vcore.objects);
 
@@ -49,25 +109,82 @@ VAPI vPObject   vCreateObject(vPObject parent)
 
 VAPI void       vDestroyObject(vPObject object)
 {
+	if (vhArchetypeChangeRefused(__func__, object)) return;
+	if (vhObjectReleaseRefused(__func__, object)) return;
+
+	vRWLockExclusive(&_vcore.objectReleaseLock); /* SYNC */
 	vDBufferLock(_vcore.objects);
 	
 	EnterCriticalSection(&object->lock);
 	DeleteCriticalSection(&object->lock);
 
+	/* object reports no components while being torn down */
+	vZeroMemory(object->componentSignature, sizeof(object->componentSignature));
+	vQueryObjectRemoved(object);
+	vHierarchyObjectDestroyed(object);
+
 	/* destroy all components */
 	for (int i = 0; i < VOBJECT_MAX_COMPONENTS; i++)
 	{
 		vPComponent comp = object->components + i;
-		if (comp->objectAttribute == NULL) continue;
+		if ((object->slotUseMask & (1 << i)) == 0) continue;
 		
 		vPComponentDescriptor cDesc = _vcore.components + comp->componentDescriptorHandle;
 		if (cDesc->objectDestroyFunc)
 			cDesc->objectDestroyFunc(object, comp);
+
+		/* detach from worker and return attribute */
+		if (cDesc->objectCycleWorker != NULL)
+			vDBufferRemove(cDesc->objectCycleList, comp->cycleDataPtr);
+		if (_vcore.objectStorageMode == OBJECT_STORAGE_SCATTERED)
+			vhReleaseComponentAttribute(cDesc, comp->objectAttribute);
 	}
 
+	/* archetype rows are released all at once */
+	if (_vcore.objectStorageMode == OBJECT_STORAGE_ARCHETYPE)
+		vArchetypeObjectRelease(object);
+	object->slotUseMask = 0;
+
 	vDBufferRemove(_vcore.objects, object);
 
 	vDBufferUnlock(_vcore.objects);
+	vRWUnlockExclusive(&_vcore.objectReleaseLock); /* UNSYNC */
+}
+
+VAPI vBOOL      vObjectSetStorageMode(vBYTE storageMode)
+{
+	vDBufferLock(_vcore.objects);
+
+	/* attributes can't be migrated, only switch while empty */
+	if (vDBufferGetElementCount(_vcore.objects) != 0)
+	{
+		vLogWarning(__func__, "Tried to change object storage mode while objects exist.");
+		vDBufferUnlock(_vcore.objects);
+		return FALSE;
+	}
+
+	_vcore.objectStorageMode = storageMode;
+	vLogInfoFormatted(__func__, "Object storage mode set to %d.", storageMode);
+
+	vDBufferUnlock(_vcore.objects);
+	return TRUE;
+}
+
+VAPI vBYTE      vObjectGetStorageMode(void)
+{
+	return _vcore.objectStorageMode;
+}
+
+
+/* ========== OBJECT HANDLES					==========	*/
+VAPI vEHNDL   vObjectGetHandle(vPObject object)
+{
+	return vDBufferGetHandle(_vcore.objects, object);
+}
+
+VAPI vPObject vObjectResolve(vEHNDL handle)
+{
+	return vDBufferResolve(_vcore.objects, handle);
 }
 
 
@@ -103,6 +220,41 @@ VAPI vUI16 vCreateComponent(vPCHAR name, vUI64 staticSize, vUI64 objectSize,
 		compD->objectDestroyFunc = destruction;
 		compD->objectCycleWorker = cycleWorker;
 		compD->objectCycleFunc   = cycle;
+
+		/* components cycled by a worker are grouped per type */
+		if (cycleWorker != NULL)
+		{
+			char listName[BUFF_SMALL];
+			vZeroMemory(listName, sizeof(listName));
+			sprintf_s(listName, BUFF_SMALL, "Component '%.32s' Cycle List",
+				compD->componentName);
+			compD->objectCycleList = vCreateDBuffer(listName, sizeof(vPComponent),
+				WORKER_COMPONENT_CYCLE_NODE_SIZE, vhComponentCycleListElementInitFunc, NULL);
+
+			if (cycle == NULL)
+			{
+				vLogWarningFormatted(__func__,
+					"Component '%s' attached to a worker with no cycle function.",
+					compD->componentName);
+			}
+
+			/* worker picks the type up on its next cycle */
+			vWorkerLock(cycleWorker);
+			_bittestandset64(cycleWorker->cycleComponents + (i >> 0x06), i & 0x3F);
+			vWorkerUnlock(cycleWorker);
+		}
+
+		/* attributes of this type are carved from one pool */
+		compD->attributePooled = (max(4, objectSize) <= COMPONENT_ATTRIBUTE_POOL_MAX);
+		if (compD->attributePooled)
+		{
+			char poolName[BUFF_SMALL];
+			vZeroMemory(poolName, sizeof(poolName));
+			sprintf_s(poolName, BUFF_SMALL, "Component '%.32s' Attributes",
+				compD->componentName);
+			compD->attributePool = vCreateDBuffer(poolName, max(4, objectSize),
+				COMPONENT_ATTRIBUTE_NODE_SIZE, NULL, NULL);
+		}
 		
 		/* allocate static block, do callback (if exists) */
 		compD->staticAttribute = vAllocZeroed(max(4, compD->staticAttributeSize));
@@ -183,6 +335,23 @@ VAPI vPComponentDescriptor vComponentGetDescriptor(vUI16 component)
 	return _vcore.components + component;
 }
 
+VAPI vBOOL vComponentSetCycleBatch(vUI16 component, vPFCOMPONENTCYCLEBATCH batchCycle)
+{
+	vPComponentDescriptor desc = _vcore.components + component;
+	if (desc->inUse == FALSE || desc->objectCycleWorker == NULL)
+	{
+		vLogWarningFormatted(__func__,
+			"Component '%d' has no cycle worker to batch on.", component);
+		return FALSE;
+	}
+
+	/* batch callback takes priority over the per-component cycle */
+	vWorkerLock(desc->objectCycleWorker);
+	desc->objectCycleBatchFunc = batchCycle;
+	vWorkerUnlock(desc->objectCycleWorker);
+	return TRUE;
+}
+
 
 /* ========== OBJECT SYNCHRONIZATION			==========	*/
 VAPI void vObjectGlobalLock(void)
@@ -209,149 +378,133 @@ VAPI void vObjectUnlock(vPObject object)
 /* ========== OBJECT COMPONENT MANIPULATION		==========	*/
 VAPI vPComponent vObjectAddComponent(vPObject object, vUI16 component, vPTR input)
 {
-	/* don't add if already existing */
-	if (vObjectHasComponent(object, component)) return FALSE;
-
 	vPComponentDescriptor desc = _vcore.components + component;
 
+	if (vhArchetypeChangeRefused(__func__, object)) return NULL;
+
 	EnterCriticalSection(&object->lock);
 
-	for (int i = 0; i < VOBJECT_MAX_COMPONENTS; i++)
+	/* don't add if already existing */
+	if (vhObjectHasComponent(object, component))
 	{
-		vPComponent comp = object->components + i;
-
-		/* if used, skip */
-		if (comp->objectAttribute != NULL) continue;
+		LeaveCriticalSection(&object->lock);
+		return NULL;
+	}
 
-		comp->componentDescriptorHandle = component;
-		comp->staticAttribute = desc->staticAttribute;
-		comp->objectAttribute = vAllocZeroed(max(4, desc->objectAttributeSize));
+	/* take lowest free slot */
+	vUI32 freeSlots = (vUI16)~object->slotUseMask;
+	if (freeSlots == 0)
+	{
+		vLogWarningFormatted(__func__, "Cannot add any more components to object '%p'.",
+			object);
+		LeaveCriticalSection(&object->lock);
+		return NULL;
+	}
 
-		/* if object has a worker to do it's cycle, attach to list */
-		if (desc->objectCycleWorker != NULL)
-		{
-			vWorkerComponentCycleData cycleData;
-			cycleData.component = comp;
-			cycleData.cycleFunc = desc->objectCycleFunc;
+	unsigned long slot;
+	_BitScanForward(&slot, freeSlots);
+	vPComponent comp = object->components + slot;
 
-			/* grab cycle data pointer */
-			comp->cycleDataPtr = 
-				vDBufferAdd(desc->objectCycleWorker->componentCycleList, &cycleData);
-		}
+	comp->componentDescriptorHandle = component;
+	comp->staticAttribute = desc->staticAttribute;
+	comp->objectAttribute = (_vcore.objectStorageMode == OBJECT_STORAGE_ARCHETYPE) ?
+		vArchetypeObjectAddComponent(object, component) :
+		vhAcquireComponentAttribute(desc);
 
-		/* call init callback if possible */
-		if (desc->objectInitFunc)
-			desc->objectInitFunc(object, comp, input);
-		
+	/* archetype storage can run out of archetypes */
+	if (comp->objectAttribute == NULL)
+	{
+		vLogWarningFormatted(__func__, "Could not store component '%d' of object '%p'.",
+			component, object);
+		vZeroMemory(comp, sizeof(vComponent));
 		LeaveCriticalSection(&object->lock);
-		return comp;
+		return NULL;
 	}
 
-	vLogWarningFormatted(__func__, "Cannot add any more components to object '%p'.",
-		object);
+	/* claim slot */
+	object->slotUseMask |= (1 << slot);
+	object->componentSlots[component] = slot;
+
+	/* call init callback if possible */
+	if (desc->objectInitFunc)
+		desc->objectInitFunc(object, comp, input);
+
+	/* if object has a worker to do it's cycle, attach to the	*/
+	/* descriptor's list so same-type components stay together	*/
+	if (desc->objectCycleWorker != NULL)
+		comp->cycleDataPtr = vDBufferAdd(desc->objectCycleList, comp);
+
+	/* publish presence bit only once initialized, lock-free	*/
+	/* readers must never see a half built component			*/
+	_bittestandset64(object->componentSignature + (component >> 0x06), component & 0x3F);
+	vQueryObjectChanged(object);
+	
 	LeaveCriticalSection(&object->lock);
-	return NULL;
+	return comp;
 }
 
 VAPI vBOOL vObjectRemoveComponent(vPObject object, vUI16 component)
 {
 	vPComponentDescriptor desc = _vcore.components + component;
 
+	if (vhArchetypeChangeRefused(__func__, object)) return FALSE;
+	if (vhObjectReleaseRefused(__func__, object)) return FALSE;
+
+	vRWLockExclusive(&_vcore.objectReleaseLock); /* SYNC */
 	EnterCriticalSection(&object->lock);
 
-	for (int i = 0; i < VOBJECT_MAX_COMPONENTS; i++)
+	if (vhObjectHasComponent(object, component) == FALSE)
 	{
-		vPComponent comp = object->components + i;
+		vLogWarningFormatted(__func__, "Could not remove component '%d' from object '%p'.",
+			component, object);
+		LeaveCriticalSection(&object->lock);
+		vRWUnlockExclusive(&_vcore.objectReleaseLock); /* UNSYNC */
+		return FALSE;
+	}
 
-		/* if unused, skip */
-		if (comp->objectAttribute == NULL) continue;
+	vUI32 slot = object->componentSlots[component];
+	vPComponent comp = object->components + slot;
 
-		/* if of not same type, skip */
-		if (comp->componentDescriptorHandle != component) continue;
+	/* call destruction callback if possible */
+	if (desc->objectDestroyFunc)
+		desc->objectDestroyFunc(object, comp);
 
-		/* call destruction callback if possible */
-		if (desc->objectDestroyFunc)
-			desc->objectDestroyFunc(object, comp);
+	/* clear presence bit before the slot goes away */
+	_bittestandreset64(object->componentSignature + (component >> 0x06), component & 0x3F);
+	vQueryObjectChanged(object);
 
-		/* remove cycle data from worker */
-		if (desc->objectCycleWorker != NULL)
-			vDBufferRemove(desc->objectCycleWorker->componentCycleList, comp->cycleDataPtr);
+	/* remove cycle data from worker */
+	if (desc->objectCycleWorker != NULL)
+		vDBufferRemove(desc->objectCycleList, comp->cycleDataPtr);
 
-		/* free object attribute memory */
-		vFree(comp->objectAttribute);
-		
-		/* zero component memory */
-		vZeroMemory(comp, sizeof(vComponent));
-
-		LeaveCriticalSection(&object->lock);
-		return TRUE;
-	}
+	/* return object attribute memory */
+	if (_vcore.objectStorageMode == OBJECT_STORAGE_ARCHETYPE)
+		vArchetypeObjectRemoveComponent(object, component);
+	else
+		vhReleaseComponentAttribute(desc, comp->objectAttribute);
+	
+	/* zero component memory */
+	vZeroMemory(comp, sizeof(vComponent));
+	object->slotUseMask &= ~(1 << slot);
 
-	vLogWarningFormatted(__func__, "Could not remove component '%d' from object '%p'.",
-		component, object);
 	LeaveCriticalSection(&object->lock);
-	return FALSE;
+	vRWUnlockExclusive(&_vcore.objectReleaseLock); /* UNSYNC */
+	return TRUE;
 }
 
 VAPI vBOOL vObjectHasComponent(vPObject object, vUI16 component)
 {
-	EnterCriticalSection(&object->lock);
-
-	for (int i = 0; i < VOBJECT_MAX_COMPONENTS; i++)
-	{
-		vPComponent comp = object->components + i;
-
-		/* if unused, skip */
-		if (comp->objectAttribute == NULL) continue;
-
-		/* if not matching skip */
-		if (comp->componentDescriptorHandle != component) continue;
-		
-		/* on match, return true */
-		LeaveCriticalSection(&object->lock);
-		return TRUE;
-	}
-
-	LeaveCriticalSection(&object->lock);
-	return FALSE;
+	/* lock-free, presence bit is only set on complete slots */
+	return vhObjectHasComponent(object, component);
 }
 
 VAPI vPComponent vObjectGetComponent(vPObject object, vUI16 component)
 {
-	EnterCriticalSection(&object->lock);
-
-	for (int i = 0; i < VOBJECT_MAX_COMPONENTS; i++)
-	{
-		vPComponent comp = object->components + i;
-
-		/* if not in use, skip */
-		if (comp->objectAttribute == NULL) continue;
-
-		/* if unmatching, skip */
-		if (comp->componentDescriptorHandle != component) continue;
-
-		/* on match, return ptr */
-		LeaveCriticalSection(&object->lock);
-		return comp;
-	}
-
-	LeaveCriticalSection(&object->lock);
-	return NULL;
+	if (vhObjectHasComponent(object, component) == FALSE) return NULL;
+	return object->components + object->componentSlots[component];
 }
 
 VAPI vUI32 vObjectGetComponentCount(vPObject object)
 {
-	EnterCriticalSection(&object->lock);
-
-	vUI32 counter = 0;
-	for (int i = 0; i < VOBJECT_MAX_COMPONENTS; i++)
-	{
-		vPComponent comp = object->components + i;
-
-		/* if used, increment counter */
-		if (comp->objectAttribute != NULL) counter++;
-	}
-
-	LeaveCriticalSection(&object->lock);
-	return counter;
-}
\ No newline at end of file
+	return __popcnt16(object->slotUseMask);
+}
@@ -15,7 +15,18 @@ VAPI vPosition  vCreatePosition(float x, float y);
 VAPI vTransform vCreateTransform(vPosition pos, float r, float s);
 VAPI vTransform vCreateTransformF(float x, float y, float r, float s);
 VAPI vPObject   vCreateObject(vPObject parent);
+/* in archetype storage, destroying and adding or removing	*/
+/* components fail with an error while the calling thread		*/
+/* holds the archetype lock shared, as component cycles do.	*/
+/* cycles must defer those changes through command buffers	*/
 VAPI void       vDestroyObject(vPObject object);
+VAPI vBOOL      vObjectSetStorageMode(vBYTE storageMode);
+VAPI vBYTE      vObjectGetStorageMode(void);
+
+
+/* ========== OBJECT HANDLES					==========	*/
+VAPI vEHNDL   vObjectGetHandle(vPObject object);
+VAPI vPObject vObjectResolve(vEHNDL handle);
 
 
 /* ========== COMPONENT CREATION				==========	*/
@@ -27,6 +38,7 @@ VAPI vUI16 vComponentGetHandleByName(vPCHAR name);
 VAPI vBOOL vComponentGetNameByHandle(vUI16 handle, vPCHAR nameBuffer, vUI32 bufferLength);
 VAPI vPTR  vComponentGetStaticPtr(vUI16 component);
 VAPI vPComponentDescriptor vComponentGetDescriptor(vUI16 component);
+VAPI vBOOL vComponentSetCycleBatch(vUI16 component, vPFCOMPONENTCYCLEBATCH batchCycle);
 
 
 /* ========== OBJECT SYNCHRONIZATION			==========	*/
@@ -40,6 +52,10 @@ VAPI void vObjectUnlock(vPObject object);
 VAPI vPComponent vObjectAddComponent(vPObject object, vUI16 component, vPTR input);
 VAPI vBOOL vObjectRemoveComponent(vPObject object, vUI16 component);
 VAPI vBOOL vObjectHasComponent(vPObject object, vUI16 component);
+
+/* in archetype storage objectAttribute moves whenever rows	*/
+/* are compacted, so it is only valid while the archetype		*/
+/* lock is held shared. component cycles already hold it		*/
 VAPI vPComponent vObjectGetComponent(vPObject object, vUI16 component);
 VAPI vUI32 vObjectGetComponentCount(vPObject object);
 
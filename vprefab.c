@@ -0,0 +1,234 @@
+
+/* ========== <vprefab.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vprefab.h"
+
+
+/* ========== HELPER							==========	*/
+static void vhPrefabPlaceComponent(vPPrefab prefab, vUI32 slot, vPObject* objects,
+	vUI32 count, vPTR* scratch)
+{
+	vPPrefabComponent	  pc   = prefab->components + slot;
+	vPComponentDescriptor desc = _vcore.components + pc->component;
+	vUI64 attributeSize = max(4, desc->objectAttributeSize);
+
+	/* scattered attributes come from one pool batch or one	*/
+	/* block each, archetype cells are filled after placement	*/
+	vBOOL scattered = (_vcore.objectStorageMode == OBJECT_STORAGE_SCATTERED);
+	if (scattered)
+	{
+		if (desc->attributePooled)
+			vDBufferAddBatch(desc->attributePool, count, NULL, scratch);
+		else
+			for (vUI32 i = 0; i < count; i++) scratch[i] = vAlloc(attributeSize);
+
+		for (vUI32 i = 0; i < count; i++)
+			vMemCopy(scratch[i], pc->attributeTemplate, attributeSize);
+	}
+
+	for (vUI32 i = 0; i < count; i++)
+	{
+		vPComponent comp = objects[i]->components + slot;
+		comp->componentDescriptorHandle = pc->component;
+		comp->staticAttribute = desc->staticAttribute;
+		comp->objectAttribute = scattered ? scratch[i] : NULL;
+		objects[i]->componentSlots[pc->component] = (vBYTE)slot;
+	}
+}
+
+static void vhPrefabRegisterCycles(vPPrefab prefab, vUI32 slot, vPObject* objects,
+	vUI32 count, vPTR* scratch)
+{
+	vPComponentDescriptor desc = _vcore.components + prefab->components[slot].component;
+	if (desc->objectCycleWorker == NULL || count == 0) return;
+
+	/* cycle entries are registered as one batch per type */
+	for (vUI32 i = 0; i < count; i++) scratch[i] = objects[i]->components + slot;
+	vDBufferAddBatch(desc->objectCycleList, count, scratch, scratch);
+	for (vUI32 i = 0; i < count; i++)
+		objects[i]->components[slot].cycleDataPtr = scratch[i];
+}
+
+static vBOOL vhPrefabPlaceArchetype(vPPrefab prefab, vPObject* objects, vUI32 count)
+{
+	vArchetypeLock(); /* SYNC */
+
+	/* each object moves once, straight into its final archetype.	*/
+	/* all share one set, so only the first place can fail		*/
+	for (vUI32 i = 0; i < count; i++)
+	{
+		if (vArchetypeObjectPlace(objects[i], prefab->signature) == FALSE)
+		{
+			vArchetypeUnlock(); /* UNSYNC */
+			return FALSE;
+		}
+		for (vUI32 s = 0; s < prefab->componentCount; s++)
+		{
+			vPPrefabComponent pc = prefab->components + s;
+			vPTR attribute = vArchetypeObjectGetAttribute(objects[i], pc->component);
+			vMemCopy(attribute, pc->attributeTemplate,
+				max(4, _vcore.components[pc->component].objectAttributeSize));
+			objects[i]->components[s].objectAttribute = attribute;
+		}
+	}
+
+	vArchetypeUnlock(); /* UNSYNC */
+	return TRUE;
+}
+
+static void vhPrefabRelease(vPPrefab prefab, vPObject* objects, vUI32 count)
+{
+	/* undo reservation of objects which never got published */
+	for (vUI32 i = 0; i < count; i++)
+	{
+		DeleteCriticalSection(&objects[i]->lock);
+		vDBufferRemove(_vcore.objects, objects[i]);
+	}
+}
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vHNDL vCreatePrefab(vPCHAR name)
+{
+	vCoreLock();
+
+	for (vHNDL i = 0; i < MAX_PREFABS; i++)
+	{
+		vPPrefab prefab = _vcore.prefabs + i;
+		if (prefab->inUse) continue;
+
+		vZeroMemory(prefab, sizeof(vPrefab));
+		vMemCopy(prefab->name, name, min(BUFF_SMALL - 1, strlen(name)));
+		prefab->inUse = TRUE;
+
+		vLogInfoFormatted(__func__, "Created prefab '%s'.", prefab->name);
+
+		vCoreUnlock();
+		return i;
+	}
+
+	vLogError(__func__, "Could not create more prefabs. Max prefabs have been created.");
+	vCoreFatalError(__func__, "Could not create more prefabs.");
+}
+
+VAPI vBOOL vDestroyPrefab(vHNDL prefab)
+{
+	if (prefab >= MAX_PREFABS) return FALSE;
+
+	vCoreLock();
+
+	vPPrefab p = _vcore.prefabs + prefab;
+	if (p->inUse == FALSE)
+	{
+		vLogWarning(__func__, "Tried to destroy prefab which doesn't exist.");
+		vCoreUnlock();
+		return FALSE;
+	}
+
+	for (vUI32 i = 0; i < p->componentCount; i++)
+		vFree(p->components[i].attributeTemplate);
+	vZeroMemory(p, sizeof(vPrefab));
+
+	vCoreUnlock();
+	return TRUE;
+}
+
+VAPI vBOOL vPrefabAddComponent(vHNDL prefab, vUI16 component, vPTR attributeTemplate)
+{
+	vCoreLock();
+
+	vPPrefab p = _vcore.prefabs + prefab;
+	if (_bittest64(p->signature + (component >> 0x06), component & 0x3F) ||
+		p->componentCount >= VOBJECT_MAX_COMPONENTS)
+	{
+		vLogWarningFormatted(__func__, "Could not add component '%d' to prefab '%s'.",
+			component, p->name);
+		vCoreUnlock();
+		return FALSE;
+	}
+
+	/* template is held at full attribute size, NULL means zeroed */
+	vUI64 attributeSize = max(4, _vcore.components[component].objectAttributeSize);
+	vPPrefabComponent pc = p->components + p->componentCount++;
+	pc->component		  = component;
+	pc->attributeTemplate = vAllocZeroed(attributeSize);
+	if (attributeTemplate)
+		vMemCopy(pc->attributeTemplate, attributeTemplate,
+			_vcore.components[component].objectAttributeSize);
+	_bittestandset64(p->signature + (component >> 0x06), component & 0x3F);
+
+	vCoreUnlock();
+	return TRUE;
+}
+
+
+/* ========== INSTANTIATION						==========	*/
+VAPI vUI32 vInstantiatePrefab(vHNDL prefab, vUI32 count, vPObject* objectsOut)
+{
+	if (prefab >= MAX_PREFABS || _vcore.prefabs[prefab].inUse == FALSE)
+	{
+		vLogWarning(__func__, "Tried to instantiate prefab which doesn't exist.");
+		return 0;
+	}
+	if (count == 0) return 0;
+
+	vPPrefab  p		  = _vcore.prefabs + prefab;
+	vPObject* objects = objectsOut ? objectsOut : vAlloc(sizeof(vPObject) * count);
+	vPTR*	  scratch = vAlloc(sizeof(vPTR) * count);
+
+	vObjectGlobalLock(); /* SYNC */
+
+	/* reserve every object slot in one pass */
+	vUI32 created = vDBufferAddBatch(_vcore.objects, count, NULL, objects);
+	for (vUI32 i = 0; i < created; i++)
+		InitializeCriticalSection(&objects[i]->lock);
+
+	/* fill components type by type, so each container is hit once */
+	for (vUI32 s = 0; s < p->componentCount; s++)
+		vhPrefabPlaceComponent(p, s, objects, created, scratch);
+	if (_vcore.objectStorageMode == OBJECT_STORAGE_ARCHETYPE && created > 0 &&
+		vhPrefabPlaceArchetype(p, objects, created) == FALSE)
+	{
+		vLogWarningFormatted(__func__, "Could not place instances of prefab '%s'.",
+			p->name);
+		vhPrefabRelease(p, objects, created);
+		created = 0;
+	}
+
+	/* claim slots */
+	vUI16 slotUseMask = (vUI16)((1 << p->componentCount) - 1);
+	for (vUI32 i = 0; i < created; i++)
+		objects[i]->slotUseMask = slotUseMask;
+
+	/* init callbacks, one component type at a time */
+	for (vUI32 s = 0; s < p->componentCount; s++)
+	{
+		vPPrefabComponent	  pc   = p->components + s;
+		vPComponentDescriptor desc = _vcore.components + pc->component;
+		if (desc->objectInitFunc == NULL) continue;
+
+		for (vUI32 i = 0; i < created; i++)
+			desc->objectInitFunc(objects[i], objects[i]->components + s, pc->attributeTemplate);
+	}
+
+	/* only initialized components reach cycles and queries */
+	for (vUI32 s = 0; s < p->componentCount; s++)
+		vhPrefabRegisterCycles(p, s, objects, created, scratch);
+
+	vQueryLock();
+	for (vUI32 i = 0; i < created; i++)
+	{
+		vMemCopy(objects[i]->componentSignature, p->signature, sizeof(p->signature));
+		vQueryObjectChanged(objects[i]);
+	}
+	vQueryUnlock();
+
+	vObjectGlobalUnlock(); /* UNSYNC */
+
+	vFree(scratch);
+	if (objectsOut == NULL) vFree(objects);
+	return created;
+}
@@ -0,0 +1,25 @@
+
+/* ========== <vprefab.h>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Object templates and bulk instantiation					*/
+
+#ifndef _VCORE_PREFAB_INCLUDE_
+#define _VCORE_PREFAB_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vHNDL vCreatePrefab(vPCHAR name);
+VAPI vBOOL vDestroyPrefab(vHNDL prefab);
+VAPI vBOOL vPrefabAddComponent(vHNDL prefab, vUI16 component, vPTR attributeTemplate);
+
+
+/* ========== INSTANTIATION						==========	*/
+/* instances get the template bytes copied into each object	*/
+/* attribute. init callbacks then run with the template as	*/
+/* input. objectsOut may be NULL							*/
+VAPI vUI32 vInstantiatePrefab(vHNDL prefab, vUI32 count, vPObject* objectsOut);
+
+#endif
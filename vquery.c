@@ -0,0 +1,277 @@
+
+/* ========== <vquery.c>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vquery.h"
+
+
+/* ========== HELPER							==========	*/
+static __forceinline vUI32 vhQueryHash(vPQuery query, vPObject object)
+{
+	/* fibonacci hashing on the object address */
+	return (vUI32)((((vUI64)object >> 0x04) * 0x9E3779B97F4A7C15ULL) >> 0x20) &
+		(query->mapCapacity - 1);
+}
+
+static __forceinline vBOOL vhQueryMatches(vPQuery query, vPObject object)
+{
+	for (int i = 0; i < COMPONENT_SIGNATURE_WORDS; i++)
+	{
+		vUI64 signature = object->componentSignature[i];
+		if ((signature & query->include[i]) != query->include[i]) return FALSE;
+		if ((signature & query->exclude[i]) != 0) return FALSE;
+	}
+	return TRUE;
+}
+
+static __forceinline vPQueryMapEntry vhQueryMapFind(vPQuery query, vPObject object)
+{
+	vUI32 mask = query->mapCapacity - 1;
+	for (vUI32 i = vhQueryHash(query, object); ; i = (i + 1) & mask)
+	{
+		vPQueryMapEntry entry = query->map + i;
+		if (entry->object == object) return entry;
+		if (entry->object == NULL)	 return NULL;
+	}
+}
+
+static __forceinline void vhQueryMapInsert(vPQuery query, vPObject object, vUI32 index)
+{
+	vUI32 mask = query->mapCapacity - 1;
+	vUI32 i = vhQueryHash(query, object);
+	while (query->map[i].object != NULL) i = (i + 1) & mask;
+
+	query->map[i].object = object;
+	query->map[i].index  = index;
+}
+
+static void vhQueryMapErase(vPQuery query, vPQueryMapEntry entry)
+{
+	/* backward shift deletion keeps probe chains intact */
+	vUI32 mask = query->mapCapacity - 1;
+	vUI32 hole = (vUI32)(entry - query->map);
+	for (vUI32 i = (hole + 1) & mask; query->map[i].object != NULL; i = (i + 1) & mask)
+	{
+		vUI32 home = vhQueryHash(query, query->map[i].object);
+
+		/* move entry if the hole lies between its home and it */
+		if (((i - home) & mask) >= ((i - hole) & mask))
+		{
+			query->map[hole] = query->map[i];
+			hole = i;
+		}
+	}
+
+	query->map[hole].object = NULL;
+	query->map[hole].index  = 0;
+}
+
+static void vhQueryGrow(vPQuery query)
+{
+	/* dense list doubles, map stays at most half full */
+	vUI32 newCapacity = max(QUERY_INITIAL_CAPACITY, query->objectCapacity << 1);
+	vPObject* newObjects = vAllocZeroed(sizeof(vPObject) * newCapacity);
+	if (query->objects)
+	{
+		vMemCopy(newObjects, query->objects, sizeof(vPObject) * query->objectCount);
+		vFree(query->objects);
+	}
+	query->objects		  = newObjects;
+	query->objectCapacity = newCapacity;
+
+	if (query->map) vFree(query->map);
+	query->mapCapacity = newCapacity << 1;
+	query->map = vAllocZeroed(sizeof(vQueryMapEntry) * query->mapCapacity);
+	for (vUI32 i = 0; i < query->objectCount; i++)
+		vhQueryMapInsert(query, query->objects[i], i);
+}
+
+static void vhQueryAdd(vPQuery query, vPObject object)
+{
+	if (query->objectCount == query->objectCapacity) vhQueryGrow(query);
+
+	vUI32 index = query->objectCount++;
+	query->objects[index] = object;
+	vhQueryMapInsert(query, object, index);
+}
+
+static void vhQueryRemove(vPQuery query, vPQueryMapEntry entry)
+{
+	/* swap last match into the hole */
+	vUI32 index = entry->index;
+	vUI32 last  = query->objectCount - 1;
+	vhQueryMapErase(query, entry);
+
+	if (index != last)
+	{
+		vPObject moved = query->objects[last];
+		query->objects[index] = moved;
+		vhQueryMapFind(query, moved)->index = index;
+	}
+
+	query->objects[last] = NULL;
+	query->objectCount--;
+}
+
+static void vhQueryUpdateObject(vPQuery query, vPObject object, vBOOL matches)
+{
+	vPQueryMapEntry entry = (query->map != NULL) ? vhQueryMapFind(query, object) : NULL;
+
+	if (matches && entry == NULL)	vhQueryAdd(query, object);
+	if (!matches && entry != NULL)	vhQueryRemove(query, entry);
+}
+
+static void vhQueryPopulateIterateFunc(vHNDL dBuffer, vPObject object, vPQuery query)
+{
+	if (vhQueryMatches(query, object)) vhQueryAdd(query, object);
+}
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vHNDL vCreateQuery(vPUI16 includeComponents, vUI32 includeCount,
+	vPUI16 excludeComponents, vUI32 excludeCount)
+{
+	/* objects before queries, same order as vDestroyObject */
+	vObjectGlobalLock(); /* SYNC */
+	vQueryLock();
+
+	for (vHNDL i = 0; i < MAX_QUERIES; i++)
+	{
+		vPQuery query = _vcore.queries + i;
+		if (query->inUse) continue;
+
+		vZeroMemory(query, sizeof(vQuery));
+		query->inUse = TRUE;
+
+		/* build component masks */
+		for (vUI32 j = 0; j < includeCount; j++)
+			_bittestandset64(query->include + (includeComponents[j] >> 0x06),
+				includeComponents[j] & 0x3F);
+		for (vUI32 j = 0; j < excludeCount; j++)
+			_bittestandset64(query->exclude + (excludeComponents[j] >> 0x06),
+				excludeComponents[j] & 0x3F);
+
+		/* collect existing matches once, then update incrementally */
+		vhQueryGrow(query);
+		vDBufferIterate(_vcore.objects, vhQueryPopulateIterateFunc, query);
+
+		vLogInfoFormatted(__func__, "Created query %d with %d initial matches.",
+			i, query->objectCount);
+
+		vQueryUnlock();
+		vObjectGlobalUnlock(); /* UNSYNC */
+		return i;
+	}
+
+	vLogError(__func__, "Could not create more queries. Max queries have been created.");
+	vCoreFatalError(__func__, "Could not create more queries.");
+}
+
+VAPI vBOOL vDestroyQuery(vHNDL query)
+{
+	if (query >= MAX_QUERIES) return FALSE;
+
+	vQueryLock(); /* SYNC */
+
+	vPQuery q = _vcore.queries + query;
+	if (q->inUse == FALSE)
+	{
+		vLogWarning(__func__, "Tried to destroy query which doesn't exist.");
+		vQueryUnlock(); /* UNSYNC */
+		return FALSE;
+	}
+
+	if (q->objects) vFree(q->objects);
+	if (q->map)		vFree(q->map);
+	vZeroMemory(q, sizeof(vQuery));
+
+	vQueryUnlock(); /* UNSYNC */
+	return TRUE;
+}
+
+
+/* ========== SYNCHRONIZATION					==========	*/
+VAPI void vQueryLock(void)
+{
+	vRWLockExclusive(&_vcore.queryLock);
+}
+
+VAPI void vQueryUnlock(void)
+{
+	vRWUnlockExclusive(&_vcore.queryLock);
+}
+
+VAPI void vQueryLockShared(void)
+{
+	vRWLockShared(&_vcore.queryLock);
+}
+
+VAPI void vQueryUnlockShared(void)
+{
+	vRWUnlockShared(&_vcore.queryLock);
+}
+
+
+/* ========== QUERY RESULTS						==========	*/
+VAPI void      vQueryIterate(vHNDL query, vPFQUERYITERATEFUNC function, vPTR input)
+{
+	if (function == NULL)
+	{
+		vLogWarning(__func__, "Tried to iterate over query with NULL function.");
+		return;
+	}
+
+	vQueryLockShared(); /* SYNC */
+
+	/* cost is proportional to the number of matches */
+	vPQuery q = _vcore.queries + query;
+	for (vUI32 i = 0; i < q->objectCount; i++)
+		function(query, q->objects[i], input);
+
+	vQueryUnlockShared(); /* UNSYNC */
+}
+
+VAPI vPObject* vQueryGetObjects(vHNDL query, vPUI32 countOut)
+{
+	/* list is only stable while the caller holds the query lock */
+	vPQuery q = _vcore.queries + query;
+	if (countOut) *countOut = q->objectCount;
+	return q->objects;
+}
+
+VAPI vUI32     vQueryGetCount(vHNDL query)
+{
+	return _vcore.queries[query].objectCount;
+}
+
+
+/* ========== OBJECT NOTIFICATION				==========	*/
+VAPI void vQueryObjectChanged(vPObject object)
+{
+	vQueryLock(); /* SYNC */
+
+	for (int i = 0; i < MAX_QUERIES; i++)
+	{
+		vPQuery query = _vcore.queries + i;
+		if (query->inUse == FALSE) continue;
+		vhQueryUpdateObject(query, object, vhQueryMatches(query, object));
+	}
+
+	vQueryUnlock(); /* UNSYNC */
+}
+
+VAPI void vQueryObjectRemoved(vPObject object)
+{
+	vQueryLock(); /* SYNC */
+
+	for (int i = 0; i < MAX_QUERIES; i++)
+	{
+		vPQuery query = _vcore.queries + i;
+		if (query->inUse == FALSE) continue;
+		vhQueryUpdateObject(query, object, FALSE);
+	}
+
+	vQueryUnlock(); /* UNSYNC */
+}
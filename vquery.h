@@ -0,0 +1,38 @@
+
+/* ========== <vquery.h>						==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Cached multi-component object queries					*/
+
+#ifndef _VCORE_QUERY_INCLUDE_
+#define _VCORE_QUERY_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vHNDL vCreateQuery(vPUI16 includeComponents, vUI32 includeCount,
+	vPUI16 excludeComponents, vUI32 excludeCount);
+VAPI vBOOL vDestroyQuery(vHNDL query);
+
+
+/* ========== SYNCHRONIZATION					==========	*/
+/* iteration callbacks must not add or remove components,	*/
+/* since match lists are updated under the exclusive lock	*/
+VAPI void vQueryLock(void);
+VAPI void vQueryUnlock(void);
+VAPI void vQueryLockShared(void);
+VAPI void vQueryUnlockShared(void);
+
+
+/* ========== QUERY RESULTS						==========	*/
+VAPI void      vQueryIterate(vHNDL query, vPFQUERYITERATEFUNC function, vPTR input);
+VAPI vPObject* vQueryGetObjects(vHNDL query, vPUI32 countOut);
+VAPI vUI32     vQueryGetCount(vHNDL query);
+
+
+/* ========== OBJECT NOTIFICATION				==========	*/
+VAPI void vQueryObjectChanged(vPObject object);
+VAPI void vQueryObjectRemoved(vPObject object);
+
+#endif
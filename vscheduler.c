@@ -0,0 +1,316 @@
+
+/* ========== <vscheduler.c>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vscheduler.h"
+#include <stdio.h>
+
+
+/* ========== HELPER							==========	*/
+static __forceinline vBOOL vhSystemsConflict(vPSystem a, vPSystem b)
+{
+	/* write/write and read/write overlaps must be ordered */
+	for (int i = 0; i < COMPONENT_SIGNATURE_WORDS; i++)
+	{
+		if (a->writes[i] & (b->reads[i] | b->writes[i])) return TRUE;
+		if (b->writes[i] & a->reads[i]) return TRUE;
+	}
+	return FALSE;
+}
+
+static vUI32 vhSchedulerBuildLevels(void)
+{
+	/* each system goes one wave after its latest conflict */
+	vUI32 levelCount = 0;
+	for (int i = 0; i < MAX_SYSTEMS; i++)
+	{
+		vPSystem system = _vcore.systems + i;
+		if (system->inUse == FALSE) continue;
+
+		system->level = 0;
+		for (int j = 0; j < i; j++)
+		{
+			vPSystem earlier = _vcore.systems + j;
+			if (earlier->inUse == FALSE) continue;
+			if (vhSystemsConflict(system, earlier))
+				system->level = max(system->level, earlier->level + 1);
+		}
+
+		system->chunkCount = 0;
+		system->workTicks  = 0;
+		levelCount = max(levelCount, system->level + 1);
+	}
+	return levelCount;
+}
+
+static __forceinline vUI32 vhSchedulerChunkSize(vUI32 objectCount, vUI32 workerCount)
+{
+	/* aim for a few chunks per worker to even out load */
+	vUI32 targetChunks = workerCount * WORKER_ITERATE_CHUNKS_PER_WORKER;
+	return max(SYSTEM_MIN_CHUNK_OBJECTS, (objectCount + targetChunks - 1) / targetChunks);
+}
+
+static void vhSchedulerChunkTask(vPWorker worker, vPTR persistentData, vPSystemChunk chunk)
+{
+	/* mark the thread so object releases from a system fail	*/
+	/* instead of waiting on the frame that is running it		*/
+	vPTR outerSystem = FlsGetValue(_vcore.systemFls);
+	FlsSetValue(_vcore.systemFls, chunk->system);
+
+	/* archetype attribute pointers only hold under this lock */
+	vBOOL archetypeStorage = (_vcore.objectStorageMode == OBJECT_STORAGE_ARCHETYPE);
+	if (archetypeStorage) vArchetypeLockShared();
+
+	LARGE_INTEGER start, end;
+	QueryPerformanceCounter(&start);
+
+	chunk->system->function(chunk->handle, chunk->objects, chunk->count,
+		chunk->system->input);
+
+	QueryPerformanceCounter(&end);
+
+	if (archetypeStorage) vArchetypeUnlockShared();
+	FlsSetValue(_vcore.systemFls, outerSystem);
+
+	InterlockedAdd64(&chunk->system->workTicks, end.QuadPart - start.QuadPart);
+}
+
+static vUI32 vhSchedulerRunLevel(vUI32 level, vPWorker* workers, vUI32 workerCount)
+{
+	/* match lists are copied under the query lock and released	*/
+	/* before dispatch, so creations and component adds never	*/
+	/* wait on a wave. releases already wait for the frame		*/
+	vQueryLockShared(); /* SYNC */
+
+	/* count chunks and objects for every system in this wave */
+	vUI32 chunkCount  = 0;
+	vUI32 objectTotal = 0;
+	for (int i = 0; i < MAX_SYSTEMS; i++)
+	{
+		vPSystem system = _vcore.systems + i;
+		if (system->inUse == FALSE || system->level != level) continue;
+
+		vUI32 objectCount = vQueryGetCount(system->query);
+		vUI32 chunkSize	  = vhSchedulerChunkSize(objectCount, workerCount);
+		system->chunkCount = (objectCount + chunkSize - 1) / chunkSize;
+		chunkCount	+= system->chunkCount;
+		objectTotal += objectCount;
+	}
+	if (chunkCount == 0)
+	{
+		vQueryUnlockShared(); /* UNSYNC */
+		return 0;
+	}
+
+	vPSystemChunk chunks  = vAllocZeroed(sizeof(vSystemChunk) * chunkCount);
+	vPTR*		  inputs  = vAllocZeroed(sizeof(vPTR) * chunkCount);
+	vPObject*	  objects = vAlloc(sizeof(vPObject) * objectTotal);
+
+	/* copy and slice each system's match list */
+	vUI32 chunkIndex  = 0;
+	vUI32 objectIndex = 0;
+	for (int i = 0; i < MAX_SYSTEMS; i++)
+	{
+		vPSystem system = _vcore.systems + i;
+		if (system->inUse == FALSE || system->level != level) continue;
+
+		vUI32	  objectCount;
+		vPObject* matches	= vQueryGetObjects(system->query, &objectCount);
+		vPObject* copy		= objects + objectIndex;
+		vUI32	  chunkSize = vhSchedulerChunkSize(objectCount, workerCount);
+		vMemCopy(copy, matches, sizeof(vPObject) * objectCount);
+		objectIndex += objectCount;
+
+		for (vUI32 start = 0; start < objectCount; start += chunkSize)
+		{
+			vPSystemChunk chunk = chunks + chunkIndex;
+			chunk->handle  = i;
+			chunk->system  = system;
+			chunk->objects = copy + start;
+			chunk->count   = min(chunkSize, objectCount - start);
+
+			inputs[chunkIndex++] = chunk;
+		}
+	}
+
+	vQueryUnlockShared(); /* UNSYNC */
+
+	vWorkerDispatchTaskGroup(workers, workerCount, vhSchedulerChunkTask, inputs, chunkCount);
+
+	vFree(objects);
+	vFree(inputs);
+	vFree(chunks);
+	return chunkCount;
+}
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vHNDL vCreateSystem(vPCHAR name, vPUI16 readComponents, vUI32 readCount,
+	vPUI16 writeComponents, vUI32 writeCount, vPFSYSTEMFUNC function, vPTR input)
+{
+	if (function == NULL)
+	{
+		vLogError(__func__, "Tried to create system with NULL function.");
+		vCoreFatalError(__func__, "Tried to create system with NULL function.");
+	}
+
+	vRWLockExclusive(&_vcore.systemLock); /* SYNC */
+
+	for (vHNDL i = 0; i < MAX_SYSTEMS; i++)
+	{
+		vPSystem system = _vcore.systems + i;
+		if (system->inUse) continue;
+
+		vZeroMemory(system, sizeof(vSystem));
+		vMemCopy(system->name, name, min(BUFF_SMALL - 1, strlen(name)));
+		system->function = function;
+		system->input	 = input;
+
+		/* build access masks */
+		for (vUI32 j = 0; j < readCount; j++)
+			_bittestandset64(system->reads + (readComponents[j] >> 0x06),
+				readComponents[j] & 0x3F);
+		for (vUI32 j = 0; j < writeCount; j++)
+			_bittestandset64(system->writes + (writeComponents[j] >> 0x06),
+				writeComponents[j] & 0x3F);
+
+		/* match objects having every accessed component */
+		vUI16 include[COMPONENTS_MAX];
+		vUI32 includeCount = 0;
+		for (vUI16 c = 0; c < COMPONENTS_MAX; c++)
+		{
+			vUI64 access = system->reads[c >> 0x06] | system->writes[c >> 0x06];
+			if (_bittest64(&access, c & 0x3F)) include[includeCount++] = c;
+		}
+		system->query = vCreateQuery(include, includeCount, NULL, 0);
+		system->inUse = TRUE;
+
+		vLogInfoFormatted(__func__, "Created system '%s' reading %d and writing %d "
+			"component types.", system->name, readCount, writeCount);
+
+		vRWUnlockExclusive(&_vcore.systemLock); /* UNSYNC */
+		return i;
+	}
+
+	vLogError(__func__, "Could not create more systems. Max systems have been created.");
+	vCoreFatalError(__func__, "Could not create more systems.");
+}
+
+VAPI vBOOL vDestroySystem(vHNDL system)
+{
+	if (system >= MAX_SYSTEMS) return FALSE;
+
+	vRWLockExclusive(&_vcore.systemLock); /* SYNC */
+
+	vPSystem s = _vcore.systems + system;
+	if (s->inUse == FALSE)
+	{
+		vLogWarning(__func__, "Tried to destroy system which doesn't exist.");
+		vRWUnlockExclusive(&_vcore.systemLock); /* UNSYNC */
+		return FALSE;
+	}
+
+	vDestroyQuery(s->query);
+	vZeroMemory(s, sizeof(vSystem));
+
+	vRWUnlockExclusive(&_vcore.systemLock); /* UNSYNC */
+	return TRUE;
+}
+
+
+/* ========== FRAME EXECUTION					==========	*/
+VAPI vBOOL vSchedulerInSystem(void)
+{
+	return FlsGetValue(_vcore.systemFls) != NULL;
+}
+
+VAPI vBOOL vSchedulerRunFrame(vPWorker* workers, vUI32 workerCount)
+{
+	if (workers == NULL || workerCount == 0)
+	{
+		vLogWarning(__func__, "Tried to run scheduler frame without workers.");
+		return FALSE;
+	}
+
+	vRWLockExclusive(&_vcore.systemLock); /* SYNC */
+
+	/* objects reached by any wave stay alive until frame end */
+	vRWLockShared(&_vcore.objectReleaseLock);
+
+	LARGE_INTEGER frequency, frameStart, frameEnd;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&frameStart);
+
+	/* waves run one after another, systems within one overlap */
+	vUI32 levelCount = vhSchedulerBuildLevels();
+	vUI32 chunkCount = 0;
+	for (vUI32 level = 0; level < levelCount; level++)
+		chunkCount += vhSchedulerRunLevel(level, workers, workerCount);
+
+	QueryPerformanceCounter(&frameEnd);
+	vRWUnlockShared(&_vcore.objectReleaseLock);
+
+	/* gather frame statistics */
+	vPSchedulerFrameStats stats = &_vcore.lastFrame;
+	LONG64 workTicks = 0;
+	stats->systemCount = 0;
+	for (int i = 0; i < MAX_SYSTEMS; i++)
+	{
+		if (_vcore.systems[i].inUse == FALSE) continue;
+		workTicks += _vcore.systems[i].workTicks;
+		stats->systemCount++;
+	}
+
+	stats->frame++;
+	stats->levelCount	   = levelCount;
+	stats->chunkCount	   = chunkCount;
+	stats->workerCount	   = workerCount;
+	stats->wallMiliseconds = (double)(frameEnd.QuadPart - frameStart.QuadPart) * 1000.0 /
+		(double)frequency.QuadPart;
+	stats->workMiliseconds = (double)workTicks * 1000.0 / (double)frequency.QuadPart;
+	stats->parallelism	   = (stats->wallMiliseconds > 0.0) ?
+		stats->workMiliseconds / stats->wallMiliseconds : 0.0;
+
+	vRWUnlockExclusive(&_vcore.systemLock); /* UNSYNC */
+	return TRUE;
+}
+
+
+/* ========== FRAME STATISTICS					==========	*/
+VAPI void   vSchedulerGetLastFrame(vPSchedulerFrameStats statsOut)
+{
+	vRWLockShared(&_vcore.systemLock);
+	vMemCopy(statsOut, &_vcore.lastFrame, sizeof(vSchedulerFrameStats));
+	vRWUnlockShared(&_vcore.systemLock);
+}
+
+VAPI void   vSchedulerLogLastFrame(void)
+{
+	vRWLockShared(&_vcore.systemLock); /* SYNC */
+
+	vPSchedulerFrameStats stats = &_vcore.lastFrame;
+	vLogInfoFormatted(__func__, "Frame %llu: %d systems in %d waves, %d chunks on %d "
+		"workers. Wall %.3fms, work %.3fms, parallelism %.2fx.", stats->frame,
+		stats->systemCount, stats->levelCount, stats->chunkCount, stats->workerCount,
+		stats->wallMiliseconds, stats->workMiliseconds, stats->parallelism);
+
+	for (int i = 0; i < MAX_SYSTEMS; i++)
+	{
+		vPSystem system = _vcore.systems + i;
+		if (system->inUse == FALSE) continue;
+
+		vLogInfoFormatted(__func__, "System '%s': wave %d, %d chunks, work %.3fms.",
+			system->name, system->level, system->chunkCount, vSystemGetLastWorkTime(i));
+	}
+
+	vRWUnlockShared(&_vcore.systemLock); /* UNSYNC */
+}
+
+VAPI double vSystemGetLastWorkTime(vHNDL system)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (double)_vcore.systems[system].workTicks * 1000.0 / (double)frequency.QuadPart;
+}
@@ -0,0 +1,44 @@
+
+/* ========== <vscheduler.h>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Parallel system scheduling with declared component access	*/
+
+#ifndef _VCORE_SCHEDULER_INCLUDE_
+#define _VCORE_SCHEDULER_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+
+
+/* ========== USAGE								==========	*/
+/* a system runs over every object holding all components	*/
+/* it reads or writes. each frame, systems are placed into	*/
+/* dependency waves in handle order: a system waits for	*/
+/* any earlier one that writes what it touches or touches	*/
+/* what it writes. systems in one wave run concurrently and	*/
+/* are split into chunks across all given workers.			*/
+/* each wave runs over a copy of the match lists taken when	*/
+/* it starts, so changes made meanwhile show up in the next	*/
+/* wave. objects are not destroyed and components are not	*/
+/* removed while a frame runs, those calls wait for the frame	*/
+/* to end. made from inside a system they fail with an error,	*/
+/* systems record them through command buffers instead		*/
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vHNDL vCreateSystem(vPCHAR name, vPUI16 readComponents, vUI32 readCount,
+	vPUI16 writeComponents, vUI32 writeCount, vPFSYSTEMFUNC function, vPTR input);
+VAPI vBOOL vDestroySystem(vHNDL system);
+
+
+/* ========== FRAME EXECUTION					==========	*/
+VAPI vBOOL vSchedulerRunFrame(vPWorker* workers, vUI32 workerCount);
+VAPI vBOOL vSchedulerInSystem(void);
+
+
+/* ========== FRAME STATISTICS					==========	*/
+VAPI void   vSchedulerGetLastFrame(vPSchedulerFrameStats statsOut);
+VAPI void   vSchedulerLogLastFrame(void);
+VAPI double vSystemGetLastWorkTime(vHNDL system);
+
+#endif
@@ -42,12 +42,38 @@ typedef struct vEntryBuffer
 } vEntryBuffer, *vPEntryBuffer;
 
 
+/* ========== READER/WRITER LOCK				==========	*/
+typedef struct vRWLock
+{
+	SRWLOCK lock;
+
+	/* exclusive mode is recursive for the owning thread */
+	volatile DWORD exclusiveOwner;
+	vUI32 exclusiveDepth;
+} vRWLock, *vPRWLock;
+
+/* every thread tracks the locks it holds shared, so nested	*/
+/* shared requests never wait behind a queued writer			*/
+typedef struct vRWLockSharedHold
+{
+	vPRWLock lock;
+	vUI32	 depth;
+} vRWLockSharedHold, *vPRWLockSharedHold;
+
+typedef struct vRWLockThreadTable
+{
+	vUI32			  count;
+	vRWLockSharedHold holds[RWLOCK_SHARED_HELD_MAX];
+} vRWLockThreadTable, *vPRWLockThreadTable;
+
+
 /* ========== BUFFER							==========	*/
 typedef struct vBuffer
 {
 	vBOOL inUse;
+	vBYTE flags;					/* BUFFER_FLAG_* creation flags			*/
 
-	CRITICAL_SECTION rwPermission;	/* thread synchronization object		*/
+	vRWLock rwPermission;			/* thread synchronization object		*/
 
 	vTIME timeCreated;
 	vCHAR name[BUFF_SMALL];
@@ -55,6 +81,7 @@ typedef struct vBuffer
 	/* element initialization and destruction callbacks */
 	vPFBUFFERINITIALIZEELEMENT	initializeFunc;
 	vPFBUFFERDESTROYELEMENT		destroyFunc;
+	vPFBUFFERRELOCATEELEMENT	relocateFunc;	/* called on compaction	*/
 
 	vUI16 elementSizeBytes;			/* size of each element					*/
 	vUI16 capacity;					/* max amount of elements storable		*/
@@ -64,11 +91,33 @@ typedef struct vBuffer
 
 	vUI16  useFieldLength;			/* useage field array size				*/
 	vPUI64 useField;				/* usage bitfield (stored on heap)		*/
+	vUI16  searchHint;				/* useField word to begin search at		*/
+	vPUI64 liveField;				/* initialized elements bitfield, only	*/
+									/* allocated for lock-free and			*/
+									/* magazine buffers						*/
+
+	struct vBufferMagazine* magazines;	/* per-thread slot caches		*/
 
 	vPBYTE data;					/* ptr to data on heap					*/
 } vBuffer, *vPBuffer;
 
 
+/* ========== BUFFER MAGAZINE					==========	*/
+/* Per-thread cache of reserved buffer slots. Slots held in a	*/
+/* magazine are set in the buffer's useField but not liveField	*/
+typedef struct vBufferMagazine
+{
+	struct vBuffer* owner;			/* NULL once owner is destroyed			*/
+	SRWLOCK lock;					/* owner thread vs. flushing thread		*/
+
+	struct vBufferMagazine* nextInThread;	/* owning thread's magazines	*/
+	struct vBufferMagazine* nextInBuffer;	/* owning buffer's magazines	*/
+
+	vUI16 count;
+	vUI16 indices[BUFFER_MAGAZINE_SIZE];
+} vBufferMagazine, *vPBufferMagazine;
+
+
 /* ========== BUFFER INFORMATION				==========	*/
 typedef struct vBufferInfo
 {
@@ -85,7 +134,48 @@ typedef struct vBufferInfo
 } vBufferInfo, *vPBufferInfo;
 
 
+/* ========== LARGE BUFFER						==========	*/
+/* Each segment is a header followed by its element data.	*/
+/* All segments are reserved up front as one virtual range	*/
+/* and committed in order as the buffer grows				*/
+typedef struct vLBufferSegment
+{
+	vUI64 elementCount;
+	vUI64 useField[LBUFFER_SEGMENT_SIZE >> 0x06];
+} vLBufferSegment, *vPLBufferSegment;
+
+typedef struct vLBuffer
+{
+	vBOOL inUse;
+
+	CRITICAL_SECTION rwPermission;	/* thread synchronization object		*/
+
+	vTIME timeCreated;
+	vCHAR name[BUFF_SMALL];
+
+	/* element initialization and destruction callbacks */
+	vPFLBUFFERINITIALIZEELEMENT initializeFunc;
+	vPFLBUFFERDESTROYELEMENT	destroyFunc;
+
+	vUI32 elementSizeBytes;			/* size of each element					*/
+	vUI64 maxCapacity;				/* max elements, segment aligned		*/
+	vUI64 capacity;					/* elements in committed segments		*/
+	vUI64 elementsUsed;				/* amount of elements used				*/
+
+	vUI64 segmentDataOffset;		/* element data offset in segment		*/
+	vUI64 segmentStrideBytes;		/* segment size, page aligned			*/
+	vUI64 segmentsReserved;
+	vUI64 segmentsCommitted;
+	vUI64 searchHint;				/* segment to begin search at			*/
+
+	vPBYTE base;					/* start of reserved virtual range		*/
+} vLBuffer, *vPLBuffer;
+
+
 /* ========== DBUFFER							==========	*/
+/* Nodes are placed at the start of a nodeAlignment aligned	*/
+/* range so the owning node of an element is found by masking	*/
+/* off the low bits of the element's address					*/
 typedef struct vDBufferNode
 {
 	struct vDBuffer* parent;
@@ -95,14 +185,34 @@ typedef struct vDBufferNode
 
 	vPUI64 useField;
 	vPTR   block;
+
+	vPTR   reservation;				/* virtual range to release	*/
+
+	/* list of nodes with free slots */
+	struct vDBufferNode* nextFree;
+	struct vDBufferNode* prevFree;
+	vBOOL  inFreeList;
+	vUI32  freeHint;				/* useField word to search first	*/
+
+	/* element handle support */
+	vUI32  nodeIndex;				/* index into parent's node table	*/
+	vPUI16 generations;				/* per slot, bumped on add/remove	*/
 } vDBufferNode, *vPDBufferNode;
 
+/* node table entries outlive their nodes so slot generations	*/
+/* keep counting up when a node index is reused				*/
+typedef struct vDBufferNodeEntry
+{
+	vPDBufferNode node;
+	vPUI16		  generations;
+} vDBufferNodeEntry, *vPDBufferNodeEntry;
+
 
 typedef struct vDBuffer
 {
 	vBOOL inUse;
 
-	CRITICAL_SECTION rwPermission;	/* sync object */
+	vRWLock rwPermission;	/* sync object */
 
 	/* element init and destroy callbacks */
 	vPFDBUFFERINITIALIZEELEMENT initializeFunc;
@@ -118,11 +228,96 @@ typedef struct vDBuffer
 	vUI64 elementSizeBytes;
 	vUI64 elementCount;
 
+	vUI64 nodeAlignment;	/* power of two >= node size in bytes	*/
+	vUI64 nodeCommitBytes;	/* page rounded node size				*/
+	vUI64 nodeGranularity;	/* alignment of every reservation		*/
+
+	/* two level node table, pages are never moved or freed	*/
+	/* until the buffer is destroyed							*/
+	vPDBufferNodeEntry* nodeTable;
+	vUI32 nodeTableUsed;
+
+	/* open addressed set of live node bases, lets a masked	*/
+	/* element address be checked before it is dereferenced	*/
+	vPDBufferNode* nodeAddresses;
+	vUI32 nodeAddressCapacity;	/* power of two						*/
+	vUI32 nodeAddressCount;
+
+	/* arena mode places nodes back to back in one reservation */
+	vPBYTE arenaReservation;
+	vPBYTE arenaBase;
+	vUI32  arenaMaxNodes;
+	vUI32  arenaNodesCommitted;
+
 	vPDBufferNode head;
 	vPDBufferNode tail;
+	vPDBufferNode freeHead;	/* first node with free slots	*/
+
+	/* node accounting for trimming */
+	vUI32 nodeCount;
+	vUI32 emptyNodeCount;
+	vUI32 trimHighWatermark;	/* auto trim above this many empty nodes	*/
+	vUI32 trimLowWatermark;		/* empty nodes kept after an auto trim		*/
 } vDBuffer, *vPDBuffer;
 
 
+/* ========== ITERATORS							==========	*/
+typedef struct vBufferIterator
+{
+	vHNDL  buffer;
+	vPBYTE data;
+	vUI64  elementSizeBytes;
+	vPUI64 field;		/* NULL for dense buffers	*/
+	vUI64  limit;		/* use field bits or dense element count	*/
+
+	/* current element or run */
+	vUI64 index;
+	vPTR  element;
+	vUI64 runLength;
+	vBOOL ended;
+} vBufferIterator, *vPBufferIterator;
+
+typedef struct vDBufferIterator
+{
+	vHNDL		  dBuffer;
+	vPDBuffer	  buffer;
+	vPDBufferNode node;
+
+	/* current element or run, index is within node */
+	vUI64 index;
+	vPTR  element;
+	vUI64 runLength;
+	vBOOL ended;
+} vDBufferIterator, *vPDBufferIterator;
+
+
+/* ========== PARALLEL ITERATION				==========	*/
+typedef struct vBufferIterateChunk
+{
+	vHNDL buffer;
+	vPFBUFFERITERATEPARALLELFUNC function;
+	vPTR  input;
+	vPTR  chunkData;
+
+	/* element range for dense buffers, word range otherwise */
+	vUI64 rangeStart;
+	vUI64 rangeEnd;
+} vBufferIterateChunk, *vPBufferIterateChunk;
+
+typedef struct vDBufferIterateChunk
+{
+	vHNDL dBuffer;
+	vPFDBUFFERITERATEPARALLELFUNC function;
+	vPTR  input;
+	vPTR  chunkData;
+
+	/* word range, which may continue into following nodes */
+	vPDBufferNode startNode;
+	vUI64 startWord;
+	vUI64 wordCount;
+} vDBufferIterateChunk, *vPDBufferIterateChunk;
+
+
 /* ========== vCOMPONENT						==========	*/
 typedef struct vComponentDescriptor
 {
@@ -135,14 +330,18 @@ typedef struct vComponentDescriptor
 	vPTR  staticAttribute;
 
 	vUI64 objectAttributeSize; /* object attribute	*/
+	vBOOL attributePooled;	   /* attributes come from attributePool	*/
+	vHNDL attributePool;
 
-	/* associated worker thread */
+	/* associated worker thread and live components of this type */
 	struct vWorker* objectCycleWorker;
+	vHNDL			objectCycleList;
 
 	/* callbacks */
 	vPFCOMPONENTINITIALIZATIONSTATIC staticInitFunc;
 	vPFCOMPONENTINITIALIZATION		 objectInitFunc;
 	vPFCOMPONENTCYCLE				 objectCycleFunc;
+	vPFCOMPONENTCYCLEBATCH			 objectCycleBatchFunc;
 	vPFCOMPONENTDESTRUCTION			 objectDestroyFunc;
 
 } vComponentDescriptor, *vPComponentDescriptor;
@@ -170,6 +369,35 @@ typedef struct vTransform
 	float scale;
 } vTransform, *vPTransform;
 
+typedef struct vTransformSoA
+{
+	/* one array per member, all capacity long */
+	float* x;
+	float* y;
+	float* rotation;
+	float* scale;
+
+	vUI32 count;
+	vUI32 capacity;
+} vTransformSoA, *vPTransformSoA;
+
+typedef struct vTransformKernels
+{
+	vBYTE level;
+
+	void  (*translate)(float* x, float* y, vUI32 count, float dx, float dy);
+	void  (*add)(float* values, vUI32 count, float delta);
+	void  (*multiply)(float* values, vUI32 count, float factor);
+	void  (*compose)(vPTransformSoA parents, vPTransformSoA locals, vPTransformSoA worlds,
+		vUI32 start, vUI32 count);
+	void  (*distance)(const float* x, const float* y, vUI32 count, float px, float py,
+		float* distancesOut);
+	vUI32 (*withinRadius)(const float* x, const float* y, vUI32 count, float px, float py,
+		float radiusSquared, vUI32 indexBase, vPUI32 indicesOut);
+	void  (*fromAoS)(vPTransformSoA store, vUI32 start, vPTransform source, vUI32 count);
+	void  (*toAoS)(vPTransformSoA store, vUI32 start, vPTransform dest, vUI32 count);
+} vTransformKernels, *vPTransformKernels;
+
 typedef struct vObject
 {
 	struct vObject* parent;	/* object parent	*/
@@ -177,9 +405,159 @@ typedef struct vObject
 
 	/* components */
 	vComponent components[VOBJECT_MAX_COMPONENTS];
+
+	/* presence bit per component handle, and the slot it uses.	*/
+	/* slots are only valid while the presence bit is set			*/
+	vUI64 componentSignature[COMPONENT_SIGNATURE_WORDS];
+	vBYTE componentSlots[COMPONENTS_MAX];
+	vUI16 slotUseMask;
+
+	/* archetype storage row, NULL archetype when unused */
+	struct vArchetype* archetype;
+	vUI64 archetypeRow;
+
+	/* child list and transform row, guarded by hierarchy lock */
+	struct vObject* firstChild;
+	struct vObject* nextSibling;
+	struct vObject* prevSibling;
+	vUI32 depth;
+	vBOOL hasHierarchyRow;
+	vUI32 hierarchyRow;
 } vObject, *vPObject;
 
 
+/* ========== HIERARCHY							==========	*/
+typedef struct vHierarchy
+{
+	/* rows are kept sorted by depth, parents before children */
+	vTransformSoA locals;
+	vTransformSoA worlds;
+	vPObject*	  objects;
+	vPUI32		  parentRows;	/* HIERARCHY_ROW_NONE for roots	*/
+	vPBYTE		  dirty;
+	vUI32		  rowCapacity;
+	vBOOL		  orderDirty;	/* rows added, removed or moved	*/
+
+	/* rows of depth d are [levelStarts[d], levelStarts[d + 1]) */
+	vPUI32 levelStarts;
+	vUI32  levelCount;
+
+	/* dirty rows of one level are composed in these */
+	vTransformSoA gatherParents;
+	vTransformSoA gatherLocals;
+	vTransformSoA gatherWorlds;
+	vPUI32		  gatherRows;
+	vUI32		  gatherCapacity;
+} vHierarchy, *vPHierarchy;
+
+typedef struct vHierarchyComposeChunk
+{
+	vPHierarchy hierarchy;
+	vUI32		start;
+	vUI32		count;
+} vHierarchyComposeChunk, *vPHierarchyComposeChunk;
+
+
+/* ========== ARCHETYPE							==========	*/
+typedef struct vArchetypeChunk
+{
+	vUI32	  rowCount;
+	vPObject* objects;							/* owning object per row	*/
+	vPBYTE	  columns[VOBJECT_MAX_COMPONENTS];	/* one per component		*/
+} vArchetypeChunk, *vPArchetypeChunk;
+
+typedef struct vArchetype
+{
+	vBOOL inUse;
+
+	/* component set, as bitmask and as ascending handles */
+	vUI64 signature[COMPONENT_SIGNATURE_WORDS];
+	vUI16 componentCount;
+	vUI16 components[VOBJECT_MAX_COMPONENTS];
+	vUI64 columnSizes[VOBJECT_MAX_COMPONENTS];
+
+	/* rows are kept dense across chunks */
+	vUI32 rowsPerChunk;
+	vUI64 rowCount;
+	vPArchetypeChunk* chunks;
+	vUI32 chunkCount;
+	vUI32 chunkCapacity;
+} vArchetype, *vPArchetype;
+
+
+/* ========== PREFAB							==========	*/
+typedef struct vPrefabComponent
+{
+	vUI16 component;
+	vPTR  attributeTemplate;	/* copied into every instance	*/
+} vPrefabComponent, *vPPrefabComponent;
+
+typedef struct vPrefab
+{
+	vBOOL inUse;
+	vCHAR name[BUFF_SMALL];
+
+	/* instances take component slots in this order */
+	vPrefabComponent components[VOBJECT_MAX_COMPONENTS];
+	vUI32			 componentCount;
+	vUI64			 signature[COMPONENT_SIGNATURE_WORDS];
+} vPrefab, *vPPrefab;
+
+
+/* ========== QUERY								==========	*/
+typedef struct vQueryMapEntry
+{
+	vPObject object;	/* NULL when empty	*/
+	vUI32	 index;		/* into dense list	*/
+} vQueryMapEntry, *vPQueryMapEntry;
+
+typedef struct vQuery
+{
+	vBOOL inUse;
+
+	/* objects must have all include and none of exclude */
+	vUI64 include[COMPONENT_SIGNATURE_WORDS];
+	vUI64 exclude[COMPONENT_SIGNATURE_WORDS];
+
+	/* dense list of matches */
+	vPObject* objects;
+	vUI32	  objectCount;
+	vUI32	  objectCapacity;
+
+	/* open addressed object to list index map */
+	vPQueryMapEntry map;
+	vUI32			mapCapacity;	/* power of two	*/
+} vQuery, *vPQuery;
+
+
+/* ========== COMMAND BUFFER					==========	*/
+typedef struct vCommand
+{
+	vBYTE  type;
+	vUI16  component;
+	vUI32  sequence;	/* recording order within batch	*/
+	vEHNDL object;		/* live or pending handle		*/
+	vEHNDL parent;
+	vPTR   input;
+} vCommand, *vPCommand;
+
+typedef struct vCommandBatch
+{
+	struct vWorker* worker;
+	vUI32			epoch;
+	vPCommand		commands;
+	vUI32			commandCount;
+	vPEHNDL			created;	/* pending index to live handle	*/
+	vUI32			createdCount;
+} vCommandBatch, *vPCommandBatch;
+
+typedef struct vCommandRef
+{
+	vPCommandBatch batch;
+	vPCommand	   command;
+} vCommandRef, *vPCommandRef;
+
+
 /* ========== WORKER					==========	*/
 typedef struct vWorker
 {
@@ -213,8 +591,26 @@ typedef struct vWorker
 	/* task list */
 	vHNDL taskList;
 
-	/* component cycle list */
-	vHNDL componentCycleList;
+	/* queued task groups, kept apart from cycleLock so a	*/
+	/* long or blocked cycle cannot hold up a dispatch		*/
+	CRITICAL_SECTION			groupLock;
+	HANDLE						wakeEvent;	/* NULL once exited	*/
+	struct vWorkerTaskGroup**	groups;
+	vUI32						groupCount;
+	vUI32						groupCapacity;
+
+	/* component types cycled by this worker */
+	vUI64 cycleComponents[COMPONENT_SIGNATURE_WORDS];
+
+	/* deferred structural changes, guarded by cycleLock */
+	vPCommand commands;
+	vUI32	  commandCount;
+	vUI32	  commandCapacity;
+	vUI32	  pendingCount;		/* objects created this batch	*/
+	vUI32	  commandEpoch;		/* batch being recorded			*/
+	vUI32	  appliedEpoch;		/* last batch applied			*/
+	vPEHNDL	  appliedCreated;	/* its pending to live handles	*/
+	vUI32	  appliedCreatedCount;
 
 } vWorker, *vPWorker;
 
@@ -230,11 +626,61 @@ typedef struct vWorkerTaskData
 	vPTR input;
 } vWorkerTaskData, *vPWorkerTaskData;
 
-typedef struct vWorkerComponentCycleData
+typedef struct vWorkerTaskGroup
 {
-	vPComponent		  component;
-	vPFCOMPONENTCYCLE cycleFunc;
-} vWorkerComponentCycleData, *vPWorkerComponentCycleData;
+	volatile LONG references;		/* dispatcher and each queued worker	*/
+	volatile LONG nextTask;			/* next unclaimed task					*/
+	volatile LONG tasksRemaining;
+	HANDLE		  completeEvent;
+
+	vPFWORKERTASK task;
+	vPTR*		  inputs;
+	vUI32		  taskCount;
+} vWorkerTaskGroup, *vPWorkerTaskGroup;
+
+
+/* ========== SYSTEM SCHEDULER					==========	*/
+typedef struct vSystem
+{
+	vBOOL inUse;
+	vCHAR name[BUFF_SMALL];
+
+	/* declared component access */
+	vUI64 reads [COMPONENT_SIGNATURE_WORDS];
+	vUI64 writes[COMPONENT_SIGNATURE_WORDS];
+
+	/* objects having every accessed component */
+	vHNDL query;
+
+	vPFSYSTEMFUNC function;
+	vPTR		  input;
+
+	/* state of the last frame */
+	vUI32		   level;		/* dependency wave			*/
+	vUI32		   chunkCount;
+	volatile LONG64 workTicks;	/* summed over all chunks	*/
+} vSystem, *vPSystem;
+
+typedef struct vSystemChunk
+{
+	vHNDL	  handle;
+	vPSystem  system;
+	vPObject* objects;
+	vUI32	  count;
+} vSystemChunk, *vPSystemChunk;
+
+typedef struct vSchedulerFrameStats
+{
+	vUI64 frame;
+	vUI32 systemCount;
+	vUI32 levelCount;
+	vUI32 chunkCount;
+	vUI32 workerCount;
+
+	double wallMiliseconds;	/* dispatch to last level done	*/
+	double workMiliseconds;	/* summed system chunk time		*/
+	double parallelism;		/* work over wall time			*/
+} vSchedulerFrameStats, *vPSchedulerFrameStats;
 
 
 /* ========== VCORE INTERNAL MEMORY LAYOUT		==========	*/
@@ -259,9 +705,14 @@ typedef struct _vCoreInternals
 	vEntryBuffer entryBuffer;			/* entry system container		*/
 
 	vBuffer  buffers[MAX_BUFFERS];		/* buffer list					*/
+	vBOOL	 magazineFlsReady;			/* magazine thread storage		*/
+	DWORD	 magazineFls;				/* has been allocated			*/
 	vDBuffer dbuffers[MAX_DBUFFERS];	/* dynamic buffer list			*/
+	vLBuffer lbuffers[MAX_LBUFFERS];	/* large buffer list			*/
 
 	CRITICAL_SECTION locks[MAX_LOCKS];	/* lock buffer					*/
+	vBOOL	 rwLockFlsReady;			/* shared lock thread tables	*/
+	DWORD	 rwLockFls;					/* have been allocated			*/
 
 	/* object dynamic buffer */
 	vHNDL objects;
@@ -272,6 +723,35 @@ typedef struct _vCoreInternals
 	/* components list */
 	vComponentDescriptor components[COMPONENTS_MAX];
 
+	/* object storage mode and archetype tables */
+	vBYTE	   objectStorageMode;
+	vRWLock	   archetypeLock;
+	vArchetype archetypes[MAX_ARCHETYPES];
+
+	/* object templates */
+	vPrefab prefabs[MAX_PREFABS];
+
+	/* transform kernels picked by cpu dispatch */
+	vTransformKernels transformKernels;
+
+	/* object hierarchy and world transforms */
+	vRWLock	   hierarchyLock;
+	vHierarchy hierarchy;
+
+	/* cached component queries */
+	vRWLock queryLock;
+	vQuery	queries[MAX_QUERIES];
+
+	/* system scheduler */
+	vRWLock				 systemLock;
+	vSystem				 systems[MAX_SYSTEMS];
+	vSchedulerFrameStats lastFrame;
+
+	/* frames hold this shared, object destruction and component	*/
+	/* removal take it exclusive so no system sees freed memory	*/
+	vRWLock				 objectReleaseLock;
+	DWORD				 systemFls;		/* system running on thread	*/
+
 } _vCoreInternals, *_vPCoreInternals;
 
 _vCoreInternals _vcore;	/* INSTANCE	*/
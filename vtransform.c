@@ -0,0 +1,619 @@
+
+/* ========== <vtransform.c>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+
+
+/* ========== INCLUDES							==========	*/
+#include "vtransform.h"
+#include <intrin.h>
+#include <immintrin.h>
+#include <math.h>
+
+
+/* ========== HELPER							==========	*/
+/* sin/cos for vector paths: reduce by 2pi in two steps,	*/
+/* fold into [-pi/2, pi/2], then taylor polynomials good	*/
+/* to about 1e-7 over the folded range						*/
+#define TRANSFORM_INV_TWO_PI	0.15915494309189533577f
+#define TRANSFORM_TWO_PI_HI		6.28125f
+#define TRANSFORM_TWO_PI_LO		0.00193530717958647692f
+#define TRANSFORM_PI			3.14159265358979323846f
+#define TRANSFORM_HALF_PI		1.57079632679489661923f
+
+static __forceinline void vhTransformScalarSinCos(float angle, float* sinOut, float* cosOut)
+{
+	*sinOut = sinf(angle);
+	*cosOut = cosf(angle);
+}
+
+static __forceinline void vhTransformSinCos4(__m128 angle, __m128* sinOut, __m128* cosOut)
+{
+	__m128 k = _mm_round_ps(_mm_mul_ps(angle, _mm_set1_ps(TRANSFORM_INV_TWO_PI)),
+		_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m128 r = _mm_sub_ps(angle, _mm_mul_ps(k, _mm_set1_ps(TRANSFORM_TWO_PI_HI)));
+	r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(TRANSFORM_TWO_PI_LO)));
+
+	/* mirror about +-pi/2, which flips the sign of cos */
+	__m128 high = _mm_cmpgt_ps(r, _mm_set1_ps(TRANSFORM_HALF_PI));
+	__m128 low	= _mm_cmplt_ps(r, _mm_set1_ps(-TRANSFORM_HALF_PI));
+	__m128 fold = _mm_or_ps(high, low);
+	__m128 mirror = _mm_blendv_ps(_mm_set1_ps(-TRANSFORM_PI), _mm_set1_ps(TRANSFORM_PI), high);
+	r = _mm_blendv_ps(r, _mm_sub_ps(mirror, r), fold);
+	__m128 cosSign = _mm_and_ps(fold, _mm_set1_ps(-0.0f));
+
+	__m128 r2 = _mm_mul_ps(r, r);
+	__m128 s = _mm_set1_ps(-1.0f / 39916800.0f);
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps( 1.0f / 362880.0f));
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.0f / 5040.0f));
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps( 1.0f / 120.0f));
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.0f / 6.0f));
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps( 1.0f));
+	*sinOut = _mm_mul_ps(s, r);
+
+	__m128 c = _mm_set1_ps(1.0f / 479001600.0f);
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.0f / 3628800.0f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps( 1.0f / 40320.0f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.0f / 720.0f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps( 1.0f / 24.0f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.0f / 2.0f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps( 1.0f));
+	*cosOut = _mm_xor_ps(c, cosSign);
+}
+
+static __forceinline void vhTransformSinCos8(__m256 angle, __m256* sinOut, __m256* cosOut)
+{
+	__m256 k = _mm256_round_ps(_mm256_mul_ps(angle, _mm256_set1_ps(TRANSFORM_INV_TWO_PI)),
+		_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(TRANSFORM_TWO_PI_HI), angle);
+	r = _mm256_fnmadd_ps(k, _mm256_set1_ps(TRANSFORM_TWO_PI_LO), r);
+
+	/* mirror about +-pi/2, which flips the sign of cos */
+	__m256 high = _mm256_cmp_ps(r, _mm256_set1_ps(TRANSFORM_HALF_PI), _CMP_GT_OQ);
+	__m256 low	= _mm256_cmp_ps(r, _mm256_set1_ps(-TRANSFORM_HALF_PI), _CMP_LT_OQ);
+	__m256 fold = _mm256_or_ps(high, low);
+	__m256 mirror = _mm256_blendv_ps(_mm256_set1_ps(-TRANSFORM_PI),
+		_mm256_set1_ps(TRANSFORM_PI), high);
+	r = _mm256_blendv_ps(r, _mm256_sub_ps(mirror, r), fold);
+	__m256 cosSign = _mm256_and_ps(fold, _mm256_set1_ps(-0.0f));
+
+	__m256 r2 = _mm256_mul_ps(r, r);
+	__m256 s = _mm256_set1_ps(-1.0f / 39916800.0f);
+	s = _mm256_fmadd_ps(s, r2, _mm256_set1_ps( 1.0f / 362880.0f));
+	s = _mm256_fmadd_ps(s, r2, _mm256_set1_ps(-1.0f / 5040.0f));
+	s = _mm256_fmadd_ps(s, r2, _mm256_set1_ps( 1.0f / 120.0f));
+	s = _mm256_fmadd_ps(s, r2, _mm256_set1_ps(-1.0f / 6.0f));
+	s = _mm256_fmadd_ps(s, r2, _mm256_set1_ps( 1.0f));
+	*sinOut = _mm256_mul_ps(s, r);
+
+	__m256 c = _mm256_set1_ps(1.0f / 479001600.0f);
+	c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps(-1.0f / 3628800.0f));
+	c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps( 1.0f / 40320.0f));
+	c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps(-1.0f / 720.0f));
+	c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps( 1.0f / 24.0f));
+	c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps(-1.0f / 2.0f));
+	c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps( 1.0f));
+	*cosOut = _mm256_xor_ps(c, cosSign);
+}
+
+static vBYTE vhTransformDetectSIMDLevel(void)
+{
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	vBOOL sse41	  = (info[2] >> 19) & 1;
+	vBOOL fma	  = (info[2] >> 12) & 1;
+	vBOOL osxsave = (info[2] >> 27) & 1;
+	vBOOL avx	  = (info[2] >> 28) & 1;
+
+	/* avx2 also needs the os to save ymm state */
+	if (maxLeaf >= 7 && osxsave && avx && fma && (_xgetbv(0) & 0x06) == 0x06)
+	{
+		__cpuidex(info, 7, 0);
+		if ((info[1] >> 5) & 1) return TRANSFORM_SIMD_AVX2;
+	}
+
+	return sse41 ? TRANSFORM_SIMD_SSE41 : TRANSFORM_SIMD_SCALAR;
+}
+
+static void vhTransformSoAReserve(vPTransformSoA store, vUI32 capacity)
+{
+	if (capacity <= store->capacity) return;
+
+	/* all four arrays share one block */
+	vUI32 newCapacity = max(capacity, store->capacity << 1);
+	newCapacity = (newCapacity + TRANSFORM_SOA_ALIGNMENT - 1) & ~(TRANSFORM_SOA_ALIGNMENT - 1);
+	float* block = vAllocZeroed(sizeof(float) * 4 * newCapacity);
+
+	if (store->x)
+	{
+		vMemCopy(block,					  store->x,		   sizeof(float) * store->count);
+		vMemCopy(block + newCapacity,	  store->y,		   sizeof(float) * store->count);
+		vMemCopy(block + newCapacity * 2, store->rotation, sizeof(float) * store->count);
+		vMemCopy(block + newCapacity * 3, store->scale,	   sizeof(float) * store->count);
+		vFree(store->x);
+	}
+
+	store->x		= block;
+	store->y		= block + newCapacity;
+	store->rotation = block + newCapacity * 2;
+	store->scale	= block + newCapacity * 3;
+	store->capacity = newCapacity;
+}
+
+
+/* ========== SCALAR KERNELS					==========	*/
+static void vhTranslateScalar(float* x, float* y, vUI32 count, float dx, float dy)
+{
+	for (vUI32 i = 0; i < count; i++)
+	{
+		x[i] += dx;
+		y[i] += dy;
+	}
+}
+
+static void vhAddScalar(float* values, vUI32 count, float delta)
+{
+	for (vUI32 i = 0; i < count; i++) values[i] += delta;
+}
+
+static void vhMultiplyScalar(float* values, vUI32 count, float factor)
+{
+	for (vUI32 i = 0; i < count; i++) values[i] *= factor;
+}
+
+static void vhComposeScalar(vPTransformSoA parents, vPTransformSoA locals,
+	vPTransformSoA worlds, vUI32 start, vUI32 count)
+{
+	for (vUI32 i = start; i < start + count; i++)
+	{
+		float s, c;
+		vhTransformScalarSinCos(parents->rotation[i], &s, &c);
+
+		float lx = locals->x[i];
+		float ly = locals->y[i];
+		float ps = parents->scale[i];
+		worlds->x[i]		= parents->x[i] + ps * (c * lx - s * ly);
+		worlds->y[i]		= parents->y[i] + ps * (s * lx + c * ly);
+		worlds->rotation[i] = parents->rotation[i] + locals->rotation[i];
+		worlds->scale[i]	= ps * locals->scale[i];
+	}
+}
+
+static void vhDistanceScalar(const float* x, const float* y, vUI32 count, float px,
+	float py, float* distancesOut)
+{
+	for (vUI32 i = 0; i < count; i++)
+	{
+		float dx = x[i] - px;
+		float dy = y[i] - py;
+		distancesOut[i] = sqrtf(dx * dx + dy * dy);
+	}
+}
+
+static vUI32 vhWithinRadiusScalar(const float* x, const float* y, vUI32 count, float px,
+	float py, float radiusSquared, vUI32 indexBase, vPUI32 indicesOut)
+{
+	vUI32 found = 0;
+	for (vUI32 i = 0; i < count; i++)
+	{
+		float dx = x[i] - px;
+		float dy = y[i] - py;
+		if (dx * dx + dy * dy <= radiusSquared) indicesOut[found++] = indexBase + i;
+	}
+	return found;
+}
+
+static void vhFromAoSScalar(vPTransformSoA store, vUI32 start, vPTransform source,
+	vUI32 count)
+{
+	for (vUI32 i = 0; i < count; i++)
+	{
+		store->x[start + i]		   = source[i].position.x;
+		store->y[start + i]		   = source[i].position.y;
+		store->rotation[start + i] = source[i].rotation;
+		store->scale[start + i]	   = source[i].scale;
+	}
+}
+
+static void vhToAoSScalar(vPTransformSoA store, vUI32 start, vPTransform dest, vUI32 count)
+{
+	for (vUI32 i = 0; i < count; i++)
+	{
+		dest[i].position.x = store->x[start + i];
+		dest[i].position.y = store->y[start + i];
+		dest[i].rotation   = store->rotation[start + i];
+		dest[i].scale	   = store->scale[start + i];
+	}
+}
+
+
+/* ========== SSE4.1 KERNELS					==========	*/
+static void vhTranslateSSE41(float* x, float* y, vUI32 count, float dx, float dy)
+{
+	__m128 vdx = _mm_set1_ps(dx);
+	__m128 vdy = _mm_set1_ps(dy);
+	vUI32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), vdx));
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), vdy));
+	}
+	vhTranslateScalar(x + i, y + i, count - i, dx, dy);
+}
+
+static void vhAddSSE41(float* values, vUI32 count, float delta)
+{
+	__m128 vdelta = _mm_set1_ps(delta);
+	vUI32 i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(values + i, _mm_add_ps(_mm_loadu_ps(values + i), vdelta));
+	vhAddScalar(values + i, count - i, delta);
+}
+
+static void vhMultiplySSE41(float* values, vUI32 count, float factor)
+{
+	__m128 vfactor = _mm_set1_ps(factor);
+	vUI32 i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(values + i, _mm_mul_ps(_mm_loadu_ps(values + i), vfactor));
+	vhMultiplyScalar(values + i, count - i, factor);
+}
+
+static void vhComposeSSE41(vPTransformSoA parents, vPTransformSoA locals,
+	vPTransformSoA worlds, vUI32 start, vUI32 count)
+{
+	vUI32 i = start;
+	vUI32 end = start + count;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 pr = _mm_loadu_ps(parents->rotation + i);
+		__m128 ps = _mm_loadu_ps(parents->scale + i);
+		__m128 lx = _mm_loadu_ps(locals->x + i);
+		__m128 ly = _mm_loadu_ps(locals->y + i);
+		__m128 s, c;
+		vhTransformSinCos4(pr, &s, &c);
+
+		__m128 rx = _mm_sub_ps(_mm_mul_ps(c, lx), _mm_mul_ps(s, ly));
+		__m128 ry = _mm_add_ps(_mm_mul_ps(s, lx), _mm_mul_ps(c, ly));
+		_mm_storeu_ps(worlds->x + i, _mm_add_ps(_mm_loadu_ps(parents->x + i), _mm_mul_ps(ps, rx)));
+		_mm_storeu_ps(worlds->y + i, _mm_add_ps(_mm_loadu_ps(parents->y + i), _mm_mul_ps(ps, ry)));
+		_mm_storeu_ps(worlds->rotation + i, _mm_add_ps(pr, _mm_loadu_ps(locals->rotation + i)));
+		_mm_storeu_ps(worlds->scale + i, _mm_mul_ps(ps, _mm_loadu_ps(locals->scale + i)));
+	}
+	vhComposeScalar(parents, locals, worlds, i, end - i);
+}
+
+static void vhDistanceSSE41(const float* x, const float* y, vUI32 count, float px,
+	float py, float* distancesOut)
+{
+	__m128 vpx = _mm_set1_ps(px);
+	__m128 vpy = _mm_set1_ps(py);
+	vUI32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), vpx);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), vpy);
+		__m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		_mm_storeu_ps(distancesOut + i, _mm_sqrt_ps(d2));
+	}
+	vhDistanceScalar(x + i, y + i, count - i, px, py, distancesOut + i);
+}
+
+static vUI32 vhWithinRadiusSSE41(const float* x, const float* y, vUI32 count, float px,
+	float py, float radiusSquared, vUI32 indexBase, vPUI32 indicesOut)
+{
+	__m128 vpx = _mm_set1_ps(px);
+	__m128 vpy = _mm_set1_ps(py);
+	__m128 vr2 = _mm_set1_ps(radiusSquared);
+	vUI32 found = 0;
+	vUI32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), vpx);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), vpy);
+		__m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+		/* compress hits out of the lane mask */
+		unsigned long mask = _mm_movemask_ps(_mm_cmple_ps(d2, vr2));
+		while (mask)
+		{
+			unsigned long bit;
+			_BitScanForward(&bit, mask);
+			mask &= mask - 1;
+			indicesOut[found++] = indexBase + i + bit;
+		}
+	}
+	return found + vhWithinRadiusScalar(x + i, y + i, count - i, px, py, radiusSquared,
+		indexBase + i, indicesOut + found);
+}
+
+static void vhFromAoSSSE41(vPTransformSoA store, vUI32 start, vPTransform source,
+	vUI32 count)
+{
+	/* a transform is four floats, so four of them transpose */
+	vUI32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 t0 = _mm_loadu_ps((float*)(source + i));
+		__m128 t1 = _mm_loadu_ps((float*)(source + i + 1));
+		__m128 t2 = _mm_loadu_ps((float*)(source + i + 2));
+		__m128 t3 = _mm_loadu_ps((float*)(source + i + 3));
+		_MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+		_mm_storeu_ps(store->x + start + i, t0);
+		_mm_storeu_ps(store->y + start + i, t1);
+		_mm_storeu_ps(store->rotation + start + i, t2);
+		_mm_storeu_ps(store->scale + start + i, t3);
+	}
+	vhFromAoSScalar(store, start + i, source + i, count - i);
+}
+
+static void vhToAoSSSE41(vPTransformSoA store, vUI32 start, vPTransform dest, vUI32 count)
+{
+	vUI32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 t0 = _mm_loadu_ps(store->x + start + i);
+		__m128 t1 = _mm_loadu_ps(store->y + start + i);
+		__m128 t2 = _mm_loadu_ps(store->rotation + start + i);
+		__m128 t3 = _mm_loadu_ps(store->scale + start + i);
+		_MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+		_mm_storeu_ps((float*)(dest + i), t0);
+		_mm_storeu_ps((float*)(dest + i + 1), t1);
+		_mm_storeu_ps((float*)(dest + i + 2), t2);
+		_mm_storeu_ps((float*)(dest + i + 3), t3);
+	}
+	vhToAoSScalar(store, start + i, dest + i, count - i);
+}
+
+
+/* ========== AVX2 KERNELS						==========	*/
+static void vhTranslateAVX2(float* x, float* y, vUI32 count, float dx, float dy)
+{
+	__m256 vdx = _mm256_set1_ps(dx);
+	__m256 vdy = _mm256_set1_ps(dy);
+	vUI32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), vdx));
+		_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), vdy));
+	}
+	vhTranslateSSE41(x + i, y + i, count - i, dx, dy);
+}
+
+static void vhAddAVX2(float* values, vUI32 count, float delta)
+{
+	__m256 vdelta = _mm256_set1_ps(delta);
+	vUI32 i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(values + i, _mm256_add_ps(_mm256_loadu_ps(values + i), vdelta));
+	vhAddSSE41(values + i, count - i, delta);
+}
+
+static void vhMultiplyAVX2(float* values, vUI32 count, float factor)
+{
+	__m256 vfactor = _mm256_set1_ps(factor);
+	vUI32 i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(values + i, _mm256_mul_ps(_mm256_loadu_ps(values + i), vfactor));
+	vhMultiplySSE41(values + i, count - i, factor);
+}
+
+static void vhComposeAVX2(vPTransformSoA parents, vPTransformSoA locals,
+	vPTransformSoA worlds, vUI32 start, vUI32 count)
+{
+	vUI32 i = start;
+	vUI32 end = start + count;
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 pr = _mm256_loadu_ps(parents->rotation + i);
+		__m256 ps = _mm256_loadu_ps(parents->scale + i);
+		__m256 lx = _mm256_loadu_ps(locals->x + i);
+		__m256 ly = _mm256_loadu_ps(locals->y + i);
+		__m256 s, c;
+		vhTransformSinCos8(pr, &s, &c);
+
+		__m256 rx = _mm256_fmsub_ps(c, lx, _mm256_mul_ps(s, ly));
+		__m256 ry = _mm256_fmadd_ps(s, lx, _mm256_mul_ps(c, ly));
+		_mm256_storeu_ps(worlds->x + i,
+			_mm256_fmadd_ps(ps, rx, _mm256_loadu_ps(parents->x + i)));
+		_mm256_storeu_ps(worlds->y + i,
+			_mm256_fmadd_ps(ps, ry, _mm256_loadu_ps(parents->y + i)));
+		_mm256_storeu_ps(worlds->rotation + i,
+			_mm256_add_ps(pr, _mm256_loadu_ps(locals->rotation + i)));
+		_mm256_storeu_ps(worlds->scale + i,
+			_mm256_mul_ps(ps, _mm256_loadu_ps(locals->scale + i)));
+	}
+	vhComposeSSE41(parents, locals, worlds, i, end - i);
+}
+
+static void vhDistanceAVX2(const float* x, const float* y, vUI32 count, float px,
+	float py, float* distancesOut)
+{
+	__m256 vpx = _mm256_set1_ps(px);
+	__m256 vpy = _mm256_set1_ps(py);
+	vUI32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), vpx);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), vpy);
+		__m256 d2 = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+		_mm256_storeu_ps(distancesOut + i, _mm256_sqrt_ps(d2));
+	}
+	vhDistanceSSE41(x + i, y + i, count - i, px, py, distancesOut + i);
+}
+
+static vUI32 vhWithinRadiusAVX2(const float* x, const float* y, vUI32 count, float px,
+	float py, float radiusSquared, vUI32 indexBase, vPUI32 indicesOut)
+{
+	__m256 vpx = _mm256_set1_ps(px);
+	__m256 vpy = _mm256_set1_ps(py);
+	__m256 vr2 = _mm256_set1_ps(radiusSquared);
+	vUI32 found = 0;
+	vUI32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), vpx);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), vpy);
+		__m256 d2 = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+
+		unsigned long mask = _mm256_movemask_ps(_mm256_cmp_ps(d2, vr2, _CMP_LE_OQ));
+		while (mask)
+		{
+			unsigned long bit;
+			_BitScanForward(&bit, mask);
+			mask &= mask - 1;
+			indicesOut[found++] = indexBase + i + bit;
+		}
+	}
+	return found + vhWithinRadiusSSE41(x + i, y + i, count - i, px, py, radiusSquared,
+		indexBase + i, indicesOut + found);
+}
+
+
+/* ========== KERNEL TABLES						==========	*/
+static const vTransformKernels vhTransformKernelsScalar =
+{
+	TRANSFORM_SIMD_SCALAR, vhTranslateScalar, vhAddScalar, vhMultiplyScalar,
+	vhComposeScalar, vhDistanceScalar, vhWithinRadiusScalar, vhFromAoSScalar,
+	vhToAoSScalar
+};
+
+static const vTransformKernels vhTransformKernelsSSE41 =
+{
+	TRANSFORM_SIMD_SSE41, vhTranslateSSE41, vhAddSSE41, vhMultiplySSE41,
+	vhComposeSSE41, vhDistanceSSE41, vhWithinRadiusSSE41, vhFromAoSSSE41,
+	vhToAoSSSE41
+};
+
+/* conversion is bound by memory, the sse transpose suffices */
+static const vTransformKernels vhTransformKernelsAVX2 =
+{
+	TRANSFORM_SIMD_AVX2, vhTranslateAVX2, vhAddAVX2, vhMultiplyAVX2,
+	vhComposeAVX2, vhDistanceAVX2, vhWithinRadiusAVX2, vhFromAoSSSE41,
+	vhToAoSSSE41
+};
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vBOOL vCreateTransformSoA(vPTransformSoA store, vUI32 capacity)
+{
+	if (store == NULL) return FALSE;
+
+	vZeroMemory(store, sizeof(vTransformSoA));
+	vhTransformSoAReserve(store, max(TRANSFORM_SOA_ALIGNMENT, capacity));
+	return TRUE;
+}
+
+VAPI void  vDestroyTransformSoA(vPTransformSoA store)
+{
+	if (store->x) vFree(store->x);
+	vZeroMemory(store, sizeof(vTransformSoA));
+}
+
+
+/* ========== AOS CONVERSION					==========	*/
+VAPI vUI32		vTransformSoAPush(vPTransformSoA store, vTransform transform)
+{
+	vhTransformSoAReserve(store, store->count + 1);
+
+	vUI32 index = store->count++;
+	store->x[index]		   = transform.position.x;
+	store->y[index]		   = transform.position.y;
+	store->rotation[index] = transform.rotation;
+	store->scale[index]	   = transform.scale;
+	return index;
+}
+
+VAPI vTransform vTransformSoAGet(vPTransformSoA store, vUI32 index)
+{
+	return vCreateTransformF(store->x[index], store->y[index], store->rotation[index],
+		store->scale[index]);
+}
+
+VAPI void		vTransformSoALoad(vPTransformSoA store, vUI32 start, vPTransform source,
+	vUI32 count)
+{
+	/* loading past the end grows the store */
+	vhTransformSoAReserve(store, start + count);
+	_vcore.transformKernels.fromAoS(store, start, source, count);
+	store->count = max(store->count, start + count);
+}
+
+VAPI void		vTransformSoAStore(vPTransformSoA store, vUI32 start, vPTransform dest,
+	vUI32 count)
+{
+	_vcore.transformKernels.toAoS(store, start, dest, count);
+}
+
+
+/* ========== BATCH KERNELS						==========	*/
+VAPI void  vTransformTranslate(vPTransformSoA store, vUI32 start, vUI32 count,
+	float dx, float dy)
+{
+	_vcore.transformKernels.translate(store->x + start, store->y + start, count, dx, dy);
+}
+
+VAPI void  vTransformRotate(vPTransformSoA store, vUI32 start, vUI32 count, float radians)
+{
+	_vcore.transformKernels.add(store->rotation + start, count, radians);
+}
+
+VAPI void  vTransformScale(vPTransformSoA store, vUI32 start, vUI32 count, float factor)
+{
+	_vcore.transformKernels.multiply(store->scale + start, count, factor);
+}
+
+VAPI void  vTransformCompose(vPTransformSoA parents, vPTransformSoA locals,
+	vPTransformSoA worlds, vUI32 start, vUI32 count)
+{
+	_vcore.transformKernels.compose(parents, locals, worlds, start, count);
+}
+
+VAPI void  vTransformDistance(vPTransformSoA store, vUI32 start, vUI32 count,
+	vPosition point, float* distancesOut)
+{
+	_vcore.transformKernels.distance(store->x + start, store->y + start, count,
+		point.x, point.y, distancesOut);
+}
+
+VAPI vUI32 vTransformQueryRadius(vPTransformSoA store, vUI32 start, vUI32 count,
+	vPosition point, float radius, vPUI32 indicesOut)
+{
+	/* indices are store indices, not offsets from start */
+	return _vcore.transformKernels.withinRadius(store->x + start, store->y + start, count,
+		point.x, point.y, radius * radius, start, indicesOut);
+}
+
+
+/* ========== CPU DISPATCH						==========	*/
+VAPI vBYTE vTransformSetSIMDLevel(vBYTE level)
+{
+	vBYTE supported = vhTransformDetectSIMDLevel();
+	level = min(level, supported);
+
+	switch (level)
+	{
+	case TRANSFORM_SIMD_AVX2:
+		_vcore.transformKernels = vhTransformKernelsAVX2;
+		break;
+
+	case TRANSFORM_SIMD_SSE41:
+		_vcore.transformKernels = vhTransformKernelsSSE41;
+		break;
+
+	default:
+		_vcore.transformKernels = vhTransformKernelsScalar;
+		break;
+	}
+
+	vLogInfoFormatted(__func__, "Transform kernels set to level %d (cpu supports %d).",
+		level, supported);
+	return level;
+}
+
+VAPI vBYTE vTransformGetSIMDLevel(void)
+{
+	return _vcore.transformKernels.level;
+}
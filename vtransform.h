@@ -0,0 +1,48 @@
+
+/* ========== <vtransform.h>					==========	*/
+/* Bailey Jia-Tao Brown							2022		*/
+/* Struct of arrays transform storage and batch kernels		*/
+
+#ifndef _VCORE_TRANSFORM_INCLUDE_
+#define _VCORE_TRANSFORM_INCLUDE_
+
+/* ========== INCLUDES							==========	*/
+#include "vcore.h"
+
+
+/* ========== CREATION AND DESTRUCTION			==========	*/
+VAPI vBOOL vCreateTransformSoA(vPTransformSoA store, vUI32 capacity);
+VAPI void  vDestroyTransformSoA(vPTransformSoA store);
+
+
+/* ========== AOS CONVERSION					==========	*/
+VAPI vUI32		vTransformSoAPush(vPTransformSoA store, vTransform transform);
+VAPI vTransform vTransformSoAGet(vPTransformSoA store, vUI32 index);
+VAPI void		vTransformSoALoad(vPTransformSoA store, vUI32 start, vPTransform source,
+	vUI32 count);
+VAPI void		vTransformSoAStore(vPTransformSoA store, vUI32 start, vPTransform dest,
+	vUI32 count);
+
+
+/* ========== BATCH KERNELS						==========	*/
+/* compose writes worlds[i] = parents[i] applied to locals[i]	*/
+/* over the same index range of all three stores				*/
+VAPI void  vTransformTranslate(vPTransformSoA store, vUI32 start, vUI32 count,
+	float dx, float dy);
+VAPI void  vTransformRotate(vPTransformSoA store, vUI32 start, vUI32 count, float radians);
+VAPI void  vTransformScale(vPTransformSoA store, vUI32 start, vUI32 count, float factor);
+VAPI void  vTransformCompose(vPTransformSoA parents, vPTransformSoA locals,
+	vPTransformSoA worlds, vUI32 start, vUI32 count);
+VAPI void  vTransformDistance(vPTransformSoA store, vUI32 start, vUI32 count,
+	vPosition point, float* distancesOut);
+VAPI vUI32 vTransformQueryRadius(vPTransformSoA store, vUI32 start, vUI32 count,
+	vPosition point, float radius, vPUI32 indicesOut);
+
+
+/* ========== CPU DISPATCH						==========	*/
+/* levels above what the cpu supports are clamped, which	*/
+/* also allows forcing the scalar path for comparison		*/
+VAPI vBYTE vTransformSetSIMDLevel(vBYTE level);
+VAPI vBYTE vTransformGetSIMDLevel(void);
+
+#endif
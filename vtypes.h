@@ -46,6 +46,8 @@ typedef vUI8   vBYTE;
 typedef vBYTE* vPBYTE;
 typedef void*  vPTR;
 typedef vUI32  vHNDL;
+typedef vUI64  vEHNDL;	/* generation checked element handle	*/
+typedef vEHNDL* vPEHNDL;
 typedef vUI64  vTIME;
 typedef vTIME* vPTIME;
 
@@ -59,17 +61,40 @@ typedef void (*vPFBUFFERINITIALIZEELEMENT )(vHNDL buffer, vUI16 index, vPTR elem
 typedef void (*vPFDBUFFERINITIALIZEELEMENT)(vHNDL dbuffer, vPTR element, vPTR input);
 
 typedef void (*vPFBUFFERDESTROYELEMENT )(vHNDL buffer, vUI16 index, vPTR element);
+typedef void (*vPFBUFFERRELOCATEELEMENT)(vHNDL buffer, vUI16 oldIndex, vUI16 newIndex,
+	vPTR element);
 typedef void (*vPFDBUFFERDESTROYELEMENT)(vHNDL dbuffer, vPTR element);
 
+typedef void (*vPFBUFFERITERATEPARALLELFUNC )(vHNDL buffer, vUI16 index, vPTR element,
+	vPTR input, vPTR chunkData);
+typedef void (*vPFDBUFFERITERATEPARALLELFUNC)(vHNDL dbuffer, vPTR element, vPTR input,
+	vPTR chunkData);
+typedef void (*vPFITERATEREDUCEFUNC)(vPTR chunkData, vPTR input);
+
+typedef void (*vPFLBUFFERITERATEFUNC	  )(vHNDL lBuffer, vUI64 index, vPTR element,
+	vPTR input);
+typedef void (*vPFLBUFFERINITIALIZEELEMENT)(vHNDL lBuffer, vUI64 index, vPTR element,
+	vPTR input);
+typedef void (*vPFLBUFFERDESTROYELEMENT   )(vHNDL lBuffer, vUI64 index, vPTR element);
+
 typedef void (*vPFCOMPONENTINITIALIZATIONSTATIC)(struct vComponentDescriptor* descriptor,
 	vPTR staticData);
 typedef void (*vPFCOMPONENTINITIALIZATION)(struct vObject* object, 
 	struct vComponent* component, vPTR input);
 typedef void (*vPFCOMPONENTCYCLE)(struct vWorker* worker, vPTR persistentData,
 	struct vComponent* component);
+typedef void (*vPFCOMPONENTCYCLEBATCH)(struct vWorker* worker, vPTR persistentData,
+	vUI16 component, struct vComponent** components, vUI32 count);
 typedef void (*vPFCOMPONENTDESTRUCTION)(struct vObject* object, 
 	struct vComponent* component);
 
+typedef void (*vPFARCHETYPECOLUMNFUNC)(vUI16 component, vPTR column,
+	struct vObject** objects, vUI32 rowCount, vPTR input);
+
+typedef void (*vPFQUERYITERATEFUNC)(vHNDL query, struct vObject* object, vPTR input);
+typedef void (*vPFSYSTEMFUNC)(vHNDL system, struct vObject** objects, vUI32 count,
+	vPTR input);
+
 typedef void (*vPFWORKERINIT )(struct vWorker* worker, vPTR persistentData, 
 	vPTR input);
 typedef void (*vPFWORKEREXIT )(struct vWorker* worker, vPTR persistentData);
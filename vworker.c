@@ -5,6 +5,7 @@
 
 /* ========== INCLUDES							==========	*/
 #include "vworker.h"
+#include "viterators.h"
 #include <stdio.h>
 
 
@@ -30,25 +31,102 @@ static void vhWorkerTaskListElementInitFunc(vHNDL buffer, vPWorkerTaskData taskD
 	vFree(input);
 }
 
-static void vhWorkerComponentCycleElementInitFunc(vHNDL buffer, 
-	vPWorkerComponentCycleData cycleData, vPWorkerComponentCycleData input)
+static void vhWorkerComponentCycleType(vPWorker worker, vUI16 component)
 {
-	cycleData->component = input->component;
-	cycleData->cycleFunc = input->cycleFunc;
+	vPComponentDescriptor desc = _vcore.components + component;
+	vDBufferIterator it;
 
-	if (input->cycleFunc == NULL)
+	/* archetype rows stay put for the whole cycle */
+	vBOOL archetypes = (_vcore.objectStorageMode == OBJECT_STORAGE_ARCHETYPE);
+	if (archetypes) vArchetypeLockShared();
+
+	/* scattered cycles may detach components, keep list exclusive */
+	vDBufferLock(desc->objectCycleList);
+
+	if (desc->objectCycleBatchFunc)
+	{
+		/* each run of live entries is a contiguous component array.	*/
+		/* batch callbacks must not detach components of their type	*/
+		for (vDBufferIteratorBeginRun(desc->objectCycleList, &it);
+			vDBufferIteratorEnd(&it) == FALSE;
+			vDBufferIteratorNextRun(&it))
+		{
+			desc->objectCycleBatchFunc(worker, worker->persistentData, component,
+				(vPComponent*)it.element, (vUI32)it.runLength);
+		}
+	}
+	else if (desc->objectCycleFunc)
+	{
+		for (vDBufferIteratorBegin(desc->objectCycleList, &it);
+			vDBufferIteratorEnd(&it) == FALSE;
+			vDBufferIteratorNext(&it))
+		{
+			desc->objectCycleFunc(worker, worker->persistentData,
+				*(vPComponent*)it.element);
+		}
+	}
+
+	vDBufferUnlock(desc->objectCycleList);
+
+	if (archetypes) vArchetypeUnlockShared();
+}
+
+static void vhWorkerComponentCycles(vPWorker worker)
+{
+	/* run component types back to back, in handle order */
+	for (int i = 0; i < COMPONENT_SIGNATURE_WORDS; i++)
+	{
+		vUI64 word = worker->cycleComponents[i];
+		while (word)
+		{
+			unsigned long bit;
+			_BitScanForward64(&bit, word);
+			word &= word - 1;
+
+			vhWorkerComponentCycleType(worker, (vUI16)((i << 0x06) + bit));
+		}
+	}
+}
+
+static void vhWorkerRunGroupTasks(vPWorker worker, vPWorkerTaskGroup group)
+{
+	/* claim tasks until none are left, others may be claiming too */
+	LONG index;
+	while ((index = InterlockedIncrement(&group->nextTask) - 1) < (LONG)group->taskCount)
 	{
-		vLogWarningFormatted(__func__,
-			"Component %p with no cycle function attached to a worker.",
-			input->component);
+		group->task(worker, worker ? worker->persistentData : NULL,
+			group->inputs ? group->inputs[index] : NULL);
+
+		/* last task to finish wakes the dispatching thread */
+		if (InterlockedDecrement(&group->tasksRemaining) == 0)
+			SetEvent(group->completeEvent);
 	}
 }
 
-static void vhWorkerComponentCycleIterateFunc(vHNDL dBuffer,
-	vPWorkerComponentCycleData data, vPWorker input)
+static void vhWorkerReleaseGroup(vPWorkerTaskGroup group)
 {
-	if (data->cycleFunc)
-		data->cycleFunc(input, input->persistentData, data->component);
+	if (InterlockedDecrement(&group->references) != 0) return;
+
+	CloseHandle(group->completeEvent);
+	vFree(group);
+}
+
+static void vhWorkerRunQueuedGroups(vPWorker worker)
+{
+	while (TRUE)
+	{
+		EnterCriticalSection(&worker->groupLock);
+		if (worker->groupCount == 0)
+		{
+			LeaveCriticalSection(&worker->groupLock);
+			return;
+		}
+		vPWorkerTaskGroup group = worker->groups[--worker->groupCount];
+		LeaveCriticalSection(&worker->groupLock);
+
+		vhWorkerRunGroupTasks(worker, group);
+		vhWorkerReleaseGroup(group);
+	}
 }
 
 static void vhWorkerExitBehavior(vPWorker worker)
@@ -62,9 +140,25 @@ static void vhWorkerExitBehavior(vPWorker worker)
 	if (worker->exitFunc)
 		worker->exitFunc(worker, worker->persistentData);
 
+	/* stop taking task groups, then finish the queued ones */
+	EnterCriticalSection(&worker->groupLock);
+	CloseHandle(worker->wakeEvent);
+	worker->wakeEvent = NULL;
+	LeaveCriticalSection(&worker->groupLock);
+	vhWorkerRunQueuedGroups(worker);
+	if (worker->groups) vFree(worker->groups);
+
 	/* free all memory and clear flags */
 	vDestroyDBuffer(worker->taskList);
-	vDestroyDBuffer(worker->componentCycleList);
+
+	/* unapplied commands are dropped with the worker */
+	if (worker->commandCount > 0)
+	{
+		vLogWarningFormatted(__func__, "Worker '%s' exited with %d unapplied commands.",
+			worker->name, worker->commandCount);
+	}
+	if (worker->commands)		vFree(worker->commands);
+	if (worker->appliedCreated) vFree(worker->appliedCreated);
 
 	vFree(worker->persistentData);
 
@@ -89,24 +183,28 @@ static DWORD WINAPI vhWorkerThreadProc(vPWorkerInput input)
 	/* start main loop */
 	while (TRUE)
 	{
-		/* wait for interval to execute cycle */
+		/* wait for interval to execute cycle, task groups wake early */
 		ULONGLONG currentTime = GetTickCount64();
 		ULONGLONG nextCycleTime = worker->lastCycleTime + worker->cycleIntervalMiliseconds;
 		if (currentTime < nextCycleTime)
 		{
-			Sleep(nextCycleTime - currentTime);
+			WaitForSingleObject(worker->wakeEvent, (DWORD)(nextCycleTime - currentTime));
+			vhWorkerRunQueuedGroups(worker);
+			continue;
 		}
+		vhWorkerRunQueuedGroups(worker);
 
 		/* LOCK THREAD */
 		EnterCriticalSection(&worker->cycleLock);
 
-		/* complete all component cycles */
-		vDBufferIterate(worker->componentCycleList,
-			vhWorkerComponentCycleIterateFunc, worker);
+		/* complete all component cycles, grouped by type */
+		vhWorkerComponentCycles(worker);
 
 		/* complete all tasks */
+		vDBufferLock(worker->taskList);
 		vDBufferIterate(worker->taskList, vhWorkerTaskIterateFunc, worker);
 		vDBufferClear(worker->taskList);
+		vDBufferUnlock(worker->taskList);
 
 		/* check for kill signal */
 		if (_bittest64(&worker->workerState, 1) == TRUE)
@@ -156,6 +254,8 @@ VAPI vPWorker vCreateWorker(vPCHAR name, vTIME cycleInterval, vPFWORKERINIT init
 		vMemCopy(worker->name, name, min(BUFF_SMALL, strlen(name)));
 
 		InitializeCriticalSection(&worker->cycleLock);
+		InitializeCriticalSection(&worker->groupLock);
+		worker->wakeEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
 		worker->cycleIntervalMiliseconds = cycleInterval;
 		worker->initFunc  = initFunc;
 		worker->exitFunc  = exitFunc;
@@ -172,12 +272,6 @@ VAPI vPWorker vCreateWorker(vPCHAR name, vTIME cycleInterval, vPFWORKERINIT init
 		worker->taskList = vCreateDBuffer(stringBuffer, sizeof(vWorkerTaskData),
 			WORKER_TASKLIST_NODE_SIZE, vhWorkerTaskListElementInitFunc, NULL);
 
-		/* initialize component cycle buffer */
-		sprintf_s(stringBuffer, BUFF_SMALL, "Worker '%s' Component Cylce List",
-			worker->name);
-		worker->componentCycleList = vCreateDBuffer(stringBuffer, sizeof(vWorkerComponentCycleData),
-			WORKER_COMPONENT_CYCLE_NODE_SIZE, vhWorkerComponentCycleElementInitFunc, NULL);
-
 		/* prepare worker input */
 		vPWorkerInput workerInput = vAllocZeroed(sizeof(vWorkerInput));
 		workerInput->worker    = worker;
@@ -339,4 +433,75 @@ VAPI vBOOL vWorkerWaitCycleCompletion(vPWorker worker, vTIME lastCycle, vTIME ma
 	}
 	
 	return TRUE;
-}
\ No newline at end of file
+}
+
+VAPI vBOOL vWorkerDispatchTaskGroup(vPWorker* workers, vUI32 workerCount,
+	vPFWORKERTASK taskFunc, vPTR* inputs, vUI32 taskCount)
+{
+	if (workers == NULL || workerCount == 0 || taskFunc == NULL)
+	{
+		vLogWarning(__func__, "Tried to dispatch task group without workers or task.");
+		return FALSE;
+	}
+	if (taskCount == 0) return TRUE;
+
+	vPWorkerTaskGroup group = vAllocZeroed(sizeof(vWorkerTaskGroup));
+	group->references	  = 1;
+	group->tasksRemaining = taskCount;
+	group->completeEvent  = CreateEventA(NULL, TRUE, FALSE, NULL);
+	group->task			  = taskFunc;
+	group->inputs		  = inputs;
+	group->taskCount	  = taskCount;
+
+	/* queue on each worker and wake it. cycleLock is never	*/
+	/* taken, so tasks start without waiting out a cycle		*/
+	vPWorker self = NULL;
+	for (vUI32 i = 0; i < workerCount; i++)
+	{
+		vPWorker worker = workers[i];
+		if (GetCurrentThreadId() == GetThreadId(worker->thread))
+		{
+			self = worker;
+			continue;
+		}
+
+		EnterCriticalSection(&worker->groupLock);
+		if (worker->wakeEvent)
+		{
+			if (worker->groupCount == worker->groupCapacity)
+			{
+				vPWorkerTaskGroup* groups = vAllocZeroed(sizeof(vPWorkerTaskGroup) *
+					(worker->groupCapacity + WORKERS_MAX));
+				if (worker->groups)
+				{
+					vMemCopy(groups, worker->groups, sizeof(vPWorkerTaskGroup) *
+						worker->groupCount);
+					vFree(worker->groups);
+				}
+				worker->groups = groups;
+				worker->groupCapacity += WORKERS_MAX;
+			}
+
+			InterlockedIncrement(&group->references);
+			worker->groups[worker->groupCount++] = group;
+			SetEvent(worker->wakeEvent);
+		}
+		LeaveCriticalSection(&worker->groupLock);
+	}
+
+	/* the calling thread takes tasks too, so the group finishes	*/
+	/* even when every worker is held up inside its cycle			*/
+	vhWorkerRunGroupTasks(self, group);
+
+	/* only tasks already running elsewhere are left to wait on */
+	DWORD result = WaitForSingleObject(group->completeEvent, INFINITE);
+	vhWorkerReleaseGroup(group);
+
+	if (result != WAIT_OBJECT_0)
+	{
+		vLogError(__func__, "Error while waiting for task group completion.");
+		return FALSE;
+	}
+
+	return TRUE;
+}
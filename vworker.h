@@ -30,6 +30,12 @@ VAPI void  vWorkerLock(vPWorker worker);
 VAPI void  vWorkerUnlock(vPWorker worker);
 VAPI vTIME vWorkerDispatchTask(vPWorker worker, vPFWORKERTASK taskFunc, vPTR input);
 VAPI vBOOL vWorkerWaitCycleCompletion(vPWorker worker, vTIME lastCycle, vTIME maxWaitTime);
+/* group tasks are claimed by the workers as soon as they are	*/
+/* woken and by the calling thread, which passes a NULL worker	*/
+/* unless it is one of the given workers. tasks never run		*/
+/* inside a worker cycle and must not rely on worker state		*/
+VAPI vBOOL vWorkerDispatchTaskGroup(vPWorker* workers, vUI32 workerCount,
+	vPFWORKERTASK taskFunc, vPTR* inputs, vUI32 taskCount);
 
 
 #endif